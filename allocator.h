@@ -54,3 +54,19 @@ struct allocator {
     }
 
 };
+
+
+
+/*
+    has_trivial_construct<Alloc> - true, если construct/destroy аллокатора ничего не добавляют к placement new и вызову
+    деструктора. Тогда контейнер может заменить поэлементное конструирование тривиально копируемых объектов на memcpy.
+    Аллокаторы без собственного construct (как std::allocator в C++20) подходят автоматически; наш allocator определяет
+    construct, но он делает ровно placement new, поэтому для него есть специализация.
+*/
+template <typename Alloc>
+struct has_trivial_construct : std::bool_constant<!requires (Alloc& a, typename Alloc::value_type* p, const typename Alloc::value_type& v) {
+    a.construct(p, v);
+}> {};
+
+template <typename T>
+struct has_trivial_construct<allocator<T>> : std::true_type {};
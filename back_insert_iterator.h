@@ -1,7 +1,19 @@
 #pragma once
 #include <iostream>
+#include <iterator>
+#include <ranges>
+#include "iterator.h"
 
 
+/*
+    Контейнер "знает" о пакетной вставке, если у него есть append(first, last) (как у нашего vector): тогда диапазон
+    добавляется с одним выделением памяти, а для тривиальных типов - одним memcpy. Иначе - push_back на каждый элемент.
+*/
+template <typename Container, typename It>
+concept bulk_appendable = requires (Container& c, It first, It last) {
+    c.append(first, last);
+};
+
 
 
 template <typename Container>
@@ -12,13 +24,20 @@ class back_insert_iterator {
 
     using iterator_category = std::output_iterator_tag;
     using value_type = void;
-    using difference_type = void;
+    using difference_type = std::ptrdiff_t;
     using pointer = void;
     using reference = void;
     using container_type = Container;
 
     back_insert_iterator(Container& container_) : container(&container_) {}
 
+    // Заранее резервирует место под reserve_hint новых элементов, если контейнер умеет reserve
+    back_insert_iterator(Container& container_, std::size_t reserve_hint) : container(&container_) {
+        if constexpr (requires { container->reserve(container->size() + reserve_hint); }) {
+            container->reserve(container->size() + reserve_hint);
+        }
+    }
+
     back_insert_iterator& operator=(const typename Container::value_type& value) {
         container->push_back(value);
         return *this;
@@ -42,9 +61,97 @@ class back_insert_iterator {
     back_insert_iterator& operator*() {
         return *this;
     }
+
+    // Пакетная вставка: для forward-итераторов размер считается заранее
+    template <typename InputIt>
+    back_insert_iterator& append(InputIt first, InputIt last) {
+        if constexpr (bulk_appendable<Container, InputIt>) {
+            container->append(first, last);
+        } else {
+            if constexpr (std::forward_iterator<InputIt> && requires { container->reserve(std::size_t()); }) {
+                container->reserve(container->size() + static_cast<std::size_t>(std::distance(first, last)));
+            }
+            for (; first != last; ++first) {
+                container->push_back(*first);
+            }
+        }
+        return *this;
+    }
+
+    Container& get_container() const noexcept {
+        return *container;
+    }
+};
+
+/*
+    Ограничение не только документирует требование: для vector<T, std::allocator<T>> ADL находит ещё и std::back_inserter,
+    и при одинаковых сигнатурах выбирается более ограниченный шаблон - наш.
+*/
+template <typename Container>
+concept back_insertable = requires (Container& c, const typename Container::value_type& value) {
+    c.push_back(value);
 };
 
 template <typename Container>
+requires back_insertable<Container>
 back_insert_iterator<Container> back_inserter(Container& c) {
     return back_insert_iterator<Container>(c);
-}
\ No newline at end of file
+}
+
+template <typename Container>
+requires back_insertable<Container>
+back_insert_iterator<Container> back_inserter(Container& c, std::size_t reserve_hint) {
+    return back_insert_iterator<Container>(c, reserve_hint);
+}
+
+
+
+/*
+    std::copy(first, last, back_inserter(v)) не может узнать размер диапазона заранее и вызывает push_back на каждый элемент.
+    Неквалифицированный copy(...) найдёт по ADL перегрузки ниже (back_insert_iterator лежит в глобальном пространстве имён),
+    которые делают одну пакетную вставку. Перегрузки для base_iterator снимают неоднозначность с copy из iterator.h.
+*/
+template <typename InputIt, typename Container>
+requires std::input_iterator<InputIt>
+back_insert_iterator<Container> copy(InputIt first, InputIt last, back_insert_iterator<Container> out) {
+    return out.append(first, last);
+}
+
+template <bool B, typename T, typename Ptr, typename Container>
+back_insert_iterator<Container> copy(base_iterator<B, T, Ptr> first, base_iterator<B, T, Ptr> last, back_insert_iterator<Container> out) {
+    return out.append(first, last);
+}
+
+template <typename InputIt, typename Size, typename Container>
+requires std::input_iterator<InputIt>
+back_insert_iterator<Container> copy_n(InputIt first, Size count, back_insert_iterator<Container> out) {
+    if constexpr (std::random_access_iterator<InputIt>) {
+        return out.append(first, first + count);
+    } else {
+        for (Size i = 0; i < count; ++i, ++first) {
+            *out = *first;
+        }
+        return out;
+    }
+}
+
+template <bool B, typename T, typename Ptr, typename Size, typename Container>
+back_insert_iterator<Container> copy_n(base_iterator<B, T, Ptr> first, Size count, back_insert_iterator<Container> out) {
+    return out.append(first, first + count);
+}
+
+
+// Добавляет весь диапазон в конец контейнера: back_insert_range(v, other) - то же, что copy(..., back_inserter(v)), но для range
+template <typename Container, std::ranges::input_range R>
+Container& back_insert_range(Container& c, R&& range) {
+    if constexpr (requires { c.append_range(std::forward<R>(range)); }) {
+        c.append_range(std::forward<R>(range));
+    } else if constexpr (std::ranges::common_range<R>) {
+        back_insert_iterator<Container>(c).append(std::ranges::begin(range), std::ranges::end(range));
+    } else {
+        for (auto&& item : range) {
+            c.push_back(std::forward<decltype(item)>(item));
+        }
+    }
+    return c;
+}
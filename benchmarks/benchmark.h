@@ -0,0 +1,401 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../perf_counters.h"
+
+
+/*
+    Небольшой самодостаточный каркас для бенчмарков.
+
+    Тело бенчмарка получает benchmark_state и крутит цикл while (state.keep_running()); таймер запускается первым вызовом
+    и останавливается, когда набрано нужное число итераций. Подготовку внутри итерации (например, копию исходного вектора
+    перед вставкой в середину) выносят за таймер через pause_timing() / resume_timing().
+
+    Для каждого бенчмарка benchmark_runner:
+        1. подбирает число итераций так, чтобы одно повторение длилось не меньше min_time;
+        2. делает warmup повторений, результаты которых отбрасываются (прогрев кэшей, страниц и предсказателя);
+        3. делает repetitions повторений и по временам на итерацию считает min / median / mean / p99.
+    p99 берётся по повторениям методом ближайшего ранга: при 15 повторениях это фактически максимум.
+
+    do_not_optimize(x) не даёт компилятору выбросить вычисление x, clobber_memory() - отложить или убрать записи в память.
+    Оба - пустые asm-вставки, кода не порождают.
+
+    После замеров времени делается ещё одно повторение с аппаратными счётчиками (perf_counters.h), и в результат попадают
+    такты, инструкции и промахи на элемент. Отдельный прогон нужен потому, что включение счётчиков - это ioctl, и в телах с
+    pause_timing() он исказил бы время. Если счётчики недоступны, колонки остаются пустыми, а в std::cerr выводится
+    одно предупреждение.
+
+    Параметры командной строки: --format=table|csv|json, --filter=<подстрока имени>, --repetitions=N, --warmup=N,
+    --min-time-ms=N, --no-counters. Хранилище результатов - std::vector: измеряющий код не должен зависеть от измеряемого.
+*/
+
+
+template <typename T>
+inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<const volatile char*>(static_cast<const volatile void*>(&value)));
+#endif
+}
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#elif defined(__GNUC__)
+    asm volatile("" : "+m,r"(value) : : "memory");
+#else
+    static_cast<void>(*static_cast<volatile char*>(static_cast<volatile void*>(&value)));
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+
+
+class benchmark_state {
+    using clock = std::chrono::steady_clock;
+
+    std::size_t iterations_;
+    std::size_t done_ = 0;
+    bool started_ = false;
+    clock::time_point start_;
+    clock::duration elapsed_{};
+
+    // Только в прогоне со счётчиками
+    perf_counters* counters_;
+    perf_sample sample_;
+
+    void start() {
+        started_ = true;
+        resume_timing();
+    }
+
+    void stop() {
+        elapsed_ += clock::now() - start_;
+        if (counters_ != nullptr) {
+            sample_ += counters_->stop();
+        }
+    }
+
+    public:
+
+    explicit benchmark_state(std::size_t iterations, perf_counters* counters = nullptr) noexcept
+    : iterations_(iterations), counters_(counters) {}
+
+    bool keep_running() {
+        if (!started_) {
+            start();
+        } else {
+            ++done_;
+        }
+        if (done_ < iterations_) {
+            return true;
+        }
+        stop();
+        return false;
+    }
+
+    void pause_timing() {
+        stop();
+    }
+
+    void resume_timing() {
+        if (counters_ != nullptr) {
+            counters_->start();
+        }
+        start_ = clock::now();
+    }
+
+    std::size_t iterations() const noexcept {
+        return iterations_;
+    }
+
+    double elapsed_ns() const noexcept {
+        return std::chrono::duration<double, std::nano>(elapsed_).count();
+    }
+
+    const perf_sample& counters() const noexcept {
+        return sample_;
+    }
+};
+
+
+
+struct benchmark_result {
+    std::string name;
+    std::size_t elements_per_iteration = 1;
+    std::size_t iterations = 0;
+    std::size_t repetitions = 0;
+
+    // Время одной итерации, нс
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double p99_ns = 0;
+
+    // Значения аппаратных счётчиков на элемент; пусто, если счётчики недоступны
+    perf_sample counters_per_element;
+
+    double median_ns_per_element() const noexcept {
+        return median_ns / static_cast<double>(elements_per_iteration);
+    }
+};
+
+
+class benchmark_runner {
+    struct benchmark_case {
+        std::string name;
+        std::size_t elements_per_iteration;
+        std::function<void(benchmark_state&)> body;
+    };
+
+    enum class output_format { table, csv, json };
+
+    std::vector<benchmark_case> cases_;
+    std::vector<benchmark_result> results_;
+
+    output_format format_ = output_format::table;
+    std::string filter_;
+    std::size_t repetitions_ = 15;
+    std::size_t warmup_ = 2;
+    double min_time_ns_ = 10e6;
+    bool use_counters_ = true;
+    perf_counters counters_;
+
+    // Ограничение сверху, чтобы тела с почти нулевым временем не крутились бесконечно
+    static constexpr std::size_t max_iterations = std::size_t(1) << 30;
+
+
+    static double run_once(const benchmark_case& c, std::size_t iterations) {
+        benchmark_state state(iterations);
+        c.body(state);
+        return state.elapsed_ns();
+    }
+
+    bool counting() const noexcept {
+        return use_counters_ && counters_.available();
+    }
+
+    std::size_t calibrate(const benchmark_case& c) const {
+        std::size_t iterations = 1;
+        while (true) {
+            double ns = run_once(c, iterations);
+            if (ns >= min_time_ns_ || iterations >= max_iterations) {
+                return iterations;
+            }
+            // Целимся чуть выше min_time, но растём не больше чем в 10 раз за шаг
+            double scale = ns > 0 ? min_time_ns_ * 1.2 / ns : 10.0;
+            iterations = std::min(max_iterations, static_cast<std::size_t>(static_cast<double>(iterations) * std::clamp(scale, 2.0, 10.0)));
+        }
+    }
+
+    benchmark_result measure(const benchmark_case& c) {
+        std::size_t iterations = calibrate(c);
+        for (std::size_t i = 0; i < warmup_; ++i) {
+            run_once(c, iterations);
+        }
+
+        std::vector<double> samples;
+        samples.reserve(repetitions_);
+        for (std::size_t i = 0; i < repetitions_; ++i) {
+            samples.push_back(run_once(c, iterations) / static_cast<double>(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        benchmark_result r;
+        r.name = c.name;
+        r.elements_per_iteration = c.elements_per_iteration;
+        r.iterations = iterations;
+        r.repetitions = samples.size();
+        r.min_ns = samples.front();
+        std::size_t n = samples.size();
+        r.median_ns = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        double sum = 0;
+        for (double s : samples) {
+            sum += s;
+        }
+        r.mean_ns = sum / static_cast<double>(n);
+        std::size_t rank = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(n)));
+        r.p99_ns = samples[std::max<std::size_t>(rank, 1) - 1];
+
+        if (counting()) {
+            benchmark_state state(iterations, &counters_);
+            c.body(state);
+            r.counters_per_element = state.counters();
+            r.counters_per_element /= static_cast<double>(iterations * c.elements_per_iteration);
+        }
+        return r;
+    }
+
+
+    static std::string json_escape(std::string_view s) {
+        std::string out;
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\') {
+                out += '\\';
+            }
+            out += ch;
+        }
+        return out;
+    }
+
+    void print_header(std::ostream& os) const {
+        if (format_ == output_format::table) {
+            os << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "iterations"
+               << std::setw(14) << "median ns" << std::setw(14) << "p99 ns" << std::setw(14) << "min ns" << std::setw(14) << "ns/element";
+            // Колонки счётчиков - только если они есть, чтобы таблица без них не была забита прочерками
+            if (counting()) {
+                for (std::size_t i = 0; i < perf_event_count; ++i) {
+                    os << std::setw(16) << perf_event_name(static_cast<perf_event>(i));
+                }
+            }
+            os << '\n';
+        } else if (format_ == output_format::csv) {
+            os << "name,elements_per_iteration,iterations,repetitions,min_ns,median_ns,mean_ns,p99_ns,median_ns_per_element";
+            for (std::size_t i = 0; i < perf_event_count; ++i) {
+                os << ',' << perf_event_name(static_cast<perf_event>(i)) << "_per_element";
+            }
+            os << '\n';
+        } else {
+            os << "[\n";
+        }
+    }
+
+    void print_result(std::ostream& os, const benchmark_result& r, bool first) const {
+        if (format_ == output_format::table) {
+            os << std::left << std::setw(48) << r.name << std::right << std::setw(12) << r.iterations << std::fixed << std::setprecision(2)
+               << std::setw(14) << r.median_ns << std::setw(14) << r.p99_ns << std::setw(14) << r.min_ns << std::setw(14)
+               << r.median_ns_per_element();
+            if (counting()) {
+                for (std::size_t i = 0; i < perf_event_count; ++i) {
+                    perf_event event = static_cast<perf_event>(i);
+                    if (r.counters_per_element.has(event)) {
+                        os << std::setw(16) << r.counters_per_element[event];
+                    } else {
+                        os << std::setw(16) << "-";
+                    }
+                }
+            }
+            os << '\n' << std::defaultfloat;
+        } else if (format_ == output_format::csv) {
+            os << r.name << ',' << r.elements_per_iteration << ',' << r.iterations << ',' << r.repetitions << ',' << r.min_ns << ','
+               << r.median_ns << ',' << r.mean_ns << ',' << r.p99_ns << ',' << r.median_ns_per_element();
+            for (std::size_t i = 0; i < perf_event_count; ++i) {
+                os << ',';
+                if (r.counters_per_element.has(static_cast<perf_event>(i))) {
+                    os << r.counters_per_element[static_cast<perf_event>(i)];
+                }
+            }
+            os << '\n';
+        } else {
+            os << (first ? "  " : ",\n  ") << "{\"name\": \"" << json_escape(r.name) << "\", \"elements_per_iteration\": " << r.elements_per_iteration
+               << ", \"iterations\": " << r.iterations << ", \"repetitions\": " << r.repetitions << ", \"min_ns\": " << r.min_ns
+               << ", \"median_ns\": " << r.median_ns << ", \"mean_ns\": " << r.mean_ns << ", \"p99_ns\": " << r.p99_ns
+               << ", \"median_ns_per_element\": " << r.median_ns_per_element() << ", \"counters_per_element\": {";
+            bool first_counter = true;
+            for (std::size_t i = 0; i < perf_event_count; ++i) {
+                perf_event event = static_cast<perf_event>(i);
+                if (r.counters_per_element.has(event)) {
+                    os << (first_counter ? "" : ", ") << '"' << perf_event_name(event) << "\": " << r.counters_per_element[event];
+                    first_counter = false;
+                }
+            }
+            os << "}}";
+        }
+    }
+
+    void print_footer(std::ostream& os) const {
+        if (format_ == output_format::json) {
+            os << "\n]\n";
+        }
+    }
+
+    static bool parse_count(std::string_view text, std::size_t& out) {
+        if (text.empty()) {
+            return false;
+        }
+        std::size_t value = 0;
+        for (char ch : text) {
+            if (ch < '0' || ch > '9') {
+                return false;
+            }
+            value = value * 10 + static_cast<std::size_t>(ch - '0');
+        }
+        out = value;
+        return true;
+    }
+
+    public:
+
+    benchmark_runner() = default;
+
+    // Возвращает false, если аргументы не распознаны; описание ошибки уже выведено в std::cerr
+    bool parse_args(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            std::size_t count = 0;
+            if (arg == "--format=table") {
+                format_ = output_format::table;
+            } else if (arg == "--format=csv") {
+                format_ = output_format::csv;
+            } else if (arg == "--format=json") {
+                format_ = output_format::json;
+            } else if (arg.starts_with("--filter=")) {
+                filter_ = arg.substr(9);
+            } else if (arg.starts_with("--repetitions=") && parse_count(arg.substr(14), count) && count > 0) {
+                repetitions_ = count;
+            } else if (arg.starts_with("--warmup=") && parse_count(arg.substr(9), count)) {
+                warmup_ = count;
+            } else if (arg.starts_with("--min-time-ms=") && parse_count(arg.substr(14), count)) {
+                min_time_ns_ = static_cast<double>(count) * 1e6;
+            } else if (arg == "--no-counters") {
+                use_counters_ = false;
+            } else {
+                std::cerr << "unknown argument: " << arg << "\n"
+                          << "usage: " << argv[0] << " [--format=table|csv|json] [--filter=substr] [--repetitions=N] [--warmup=N] [--min-time-ms=N] [--no-counters]\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // elements_per_iteration - сколько элементов обрабатывает одна итерация; по нему считается ns/element
+    void add(std::string name, std::size_t elements_per_iteration, std::function<void(benchmark_state&)> body) {
+        cases_.push_back({std::move(name), std::max<std::size_t>(elements_per_iteration, 1), std::move(body)});
+    }
+
+    // Результаты печатаются по мере готовности, чтобы долгий прогон было видно
+    const std::vector<benchmark_result>& run(std::ostream& os = std::cout) {
+        results_.clear();
+        if (use_counters_ && !counters_.available()) {
+            std::cerr << "hardware counters are unavailable (perf_event_open failed), reporting time only\n";
+        }
+        print_header(os);
+        for (const benchmark_case& c : cases_) {
+            if (!filter_.empty() && c.name.find(filter_) == std::string::npos) {
+                continue;
+            }
+            results_.push_back(measure(c));
+            print_result(os, results_.back(), results_.size() == 1);
+            os.flush();
+        }
+        print_footer(os);
+        return results_;
+    }
+};
@@ -0,0 +1,295 @@
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "benchmark.h"
+#include "../vector.h"
+#include "../smart_pointers/unique_ptr.h"
+
+
+/*
+    Сравнение vector и unique_ptr из этого репозитория с std::vector и std::unique_ptr.
+
+    Каждая операция прогоняется для int, std::string (32 символа - заведомо не SSO) и 64-байтной тривиально копируемой
+    структуры на нескольких размерах. Имена имеют вид операция/контейнер<тип>/размер, поэтому
+        containers_benchmark --filter=insert_middle --format=csv
+    даёт готовую таблицу для сравнения. ns/element - время итерации, делённое на число обработанных элементов.
+
+    insert_middle и erase_middle восстанавливают исходный вектор вне таймера (pause_timing), так что измеряется одна
+    вставка или одно удаление в середине вектора размера n.
+*/
+
+
+struct blob64 {
+    std::uint64_t words[8];
+
+    blob64() = default;
+
+    explicit blob64(std::size_t seed) noexcept {
+        for (std::size_t i = 0; i < 8; ++i) {
+            words[i] = seed + i;
+        }
+    }
+};
+
+
+// Как получить i-й элемент и как построить его на месте
+template <typename T>
+struct bench_value;
+
+template <>
+struct bench_value<int> {
+    static constexpr const char* name = "int";
+
+    static int make(std::size_t i) {
+        return static_cast<int>(i);
+    }
+
+    template <typename Vec>
+    static void emplace(Vec& v, std::size_t i) {
+        v.emplace_back(static_cast<int>(i));
+    }
+};
+
+template <>
+struct bench_value<std::string> {
+    static constexpr const char* name = "string";
+
+    static std::string make(std::size_t i) {
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+
+    template <typename Vec>
+    static void emplace(Vec& v, std::size_t i) {
+        v.emplace_back(std::size_t(32), static_cast<char>('a' + i % 26));
+    }
+};
+
+template <>
+struct bench_value<blob64> {
+    static constexpr const char* name = "blob64";
+
+    static blob64 make(std::size_t i) {
+        return blob64(i);
+    }
+
+    template <typename Vec>
+    static void emplace(Vec& v, std::size_t i) {
+        v.emplace_back(i);
+    }
+};
+
+
+template <typename Vec>
+Vec make_filled(std::size_t n) {
+    using T = typename Vec::value_type;
+    Vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v.push_back(bench_value<T>::make(i));
+    }
+    return v;
+}
+
+
+template <template <typename...> typename Vec, typename T>
+void add_vector_benchmarks(benchmark_runner& runner, const std::string& container, std::size_t n) {
+    using vec = Vec<T>;
+    std::string suffix = "/" + container + "<" + bench_value<T>::name + ">/" + std::to_string(n);
+
+    runner.add("push_back" + suffix, n, [n](benchmark_state& state) {
+        T value = bench_value<T>::make(7);
+        while (state.keep_running()) {
+            vec v;
+            for (std::size_t i = 0; i < n; ++i) {
+                v.push_back(value);
+            }
+            do_not_optimize(v.data());
+        }
+    });
+
+    runner.add("emplace_back" + suffix, n, [n](benchmark_state& state) {
+        while (state.keep_running()) {
+            vec v;
+            for (std::size_t i = 0; i < n; ++i) {
+                bench_value<T>::emplace(v, i);
+            }
+            do_not_optimize(v.data());
+        }
+    });
+
+    runner.add("insert_middle" + suffix, 1, [n](benchmark_state& state) {
+        vec v = make_filled<vec>(n);
+        v.reserve(n + 1);
+        T value = bench_value<T>::make(n);
+        while (state.keep_running()) {
+            v.insert(v.begin() + static_cast<std::ptrdiff_t>(n / 2), value);
+            clobber_memory();
+            state.pause_timing();
+            v.erase(v.begin() + static_cast<std::ptrdiff_t>(n / 2));
+            state.resume_timing();
+        }
+    });
+
+    runner.add("erase_middle" + suffix, 1, [n](benchmark_state& state) {
+        vec v = make_filled<vec>(n);
+        v.reserve(n + 1);
+        T value = bench_value<T>::make(n);
+        while (state.keep_running()) {
+            v.erase(v.begin() + static_cast<std::ptrdiff_t>(n / 2));
+            clobber_memory();
+            state.pause_timing();
+            v.insert(v.begin() + static_cast<std::ptrdiff_t>(n / 2), value);
+            state.resume_timing();
+        }
+    });
+
+    // Присваивание в вектор, у которого ёмкости уже хватает
+    runner.add("assign_range" + suffix, n, [n](benchmark_state& state) {
+        const vec src = make_filled<vec>(n);
+        vec dst = make_filled<vec>(n);
+        while (state.keep_running()) {
+            dst.assign(src.begin(), src.end());
+            do_not_optimize(dst.data());
+        }
+    });
+
+    runner.add("assign_fill" + suffix, n, [n](benchmark_state& state) {
+        vec dst = make_filled<vec>(n);
+        T value = bench_value<T>::make(3);
+        while (state.keep_running()) {
+            dst.assign(n, value);
+            do_not_optimize(dst.data());
+        }
+    });
+
+    runner.add("copy" + suffix, n, [n](benchmark_state& state) {
+        const vec src = make_filled<vec>(n);
+        while (state.keep_running()) {
+            vec copy(src);
+            do_not_optimize(copy.data());
+        }
+    });
+
+    // Перемещение туда и обратно: от размера не зависит, ns/element здесь - время на пару перемещений
+    runner.add("move" + suffix, 1, [n](benchmark_state& state) {
+        vec a = make_filled<vec>(n);
+        while (state.keep_running()) {
+            vec b(std::move(a));
+            do_not_optimize(b.data());
+            a = std::move(b);
+            do_not_optimize(a.data());
+        }
+    });
+
+    runner.add("reserve_shrink" + suffix, n / 2, [n](benchmark_state& state) {
+        T value = bench_value<T>::make(5);
+        while (state.keep_running()) {
+            vec v;
+            v.reserve(n);
+            for (std::size_t i = 0; i < n / 2; ++i) {
+                v.push_back(value);
+            }
+            v.shrink_to_fit();
+            do_not_optimize(v.data());
+        }
+    });
+}
+
+
+template <typename T>
+using repo_vector = vector<T>;
+
+template <typename T>
+using std_vector = std::vector<T>;
+
+
+template <typename T>
+void add_unique_ptr_benchmarks(benchmark_runner& runner, std::size_t n) {
+    std::string suffix = std::string("<") + bench_value<T>::name + ">";
+
+    runner.add("make_unique/unique_ptr" + suffix, 1, [](benchmark_state& state) {
+        while (state.keep_running()) {
+            auto p = ::make_unique<T>(bench_value<T>::make(1));
+            do_not_optimize(p.get());
+        }
+    });
+
+    runner.add("make_unique/std::unique_ptr" + suffix, 1, [](benchmark_state& state) {
+        while (state.keep_running()) {
+            auto p = std::make_unique<T>(bench_value<T>::make(1));
+            do_not_optimize(p.get());
+        }
+    });
+
+    runner.add("move/unique_ptr" + suffix, 1, [](benchmark_state& state) {
+        auto a = ::make_unique<T>(bench_value<T>::make(1));
+        while (state.keep_running()) {
+            unique_ptr<T> b(std::move(a));
+            do_not_optimize(b.get());
+            a = std::move(b);
+            do_not_optimize(a.get());
+        }
+    });
+
+    runner.add("move/std::unique_ptr" + suffix, 1, [](benchmark_state& state) {
+        auto a = std::make_unique<T>(bench_value<T>::make(1));
+        while (state.keep_running()) {
+            std::unique_ptr<T> b(std::move(a));
+            do_not_optimize(b.get());
+            a = std::move(b);
+            do_not_optimize(a.get());
+        }
+    });
+
+    // Вектор указателей: при росте unique_ptr перемещаются, а не копируются
+    std::string sized = suffix + "/" + std::to_string(n);
+
+    runner.add("vector_of/unique_ptr" + sized, n, [n](benchmark_state& state) {
+        while (state.keep_running()) {
+            vector<unique_ptr<T>> v;
+            for (std::size_t i = 0; i < n; ++i) {
+                v.push_back(::make_unique<T>(bench_value<T>::make(i)));
+            }
+            do_not_optimize(v.data());
+        }
+    });
+
+    runner.add("vector_of/std::unique_ptr" + sized, n, [n](benchmark_state& state) {
+        while (state.keep_running()) {
+            std::vector<std::unique_ptr<T>> v;
+            for (std::size_t i = 0; i < n; ++i) {
+                v.push_back(std::make_unique<T>(bench_value<T>::make(i)));
+            }
+            do_not_optimize(v.data());
+        }
+    });
+}
+
+
+template <typename T>
+void add_type(benchmark_runner& runner) {
+    for (std::size_t n : {std::size_t(1) << 10, std::size_t(1) << 16}) {
+        add_vector_benchmarks<repo_vector, T>(runner, "vector", n);
+        add_vector_benchmarks<std_vector, T>(runner, "std::vector", n);
+    }
+    add_unique_ptr_benchmarks<T>(runner, std::size_t(1) << 12);
+}
+
+
+int main(int argc, char** argv) {
+    benchmark_runner runner;
+    if (!runner.parse_args(argc, argv)) {
+        return 2;
+    }
+
+    add_type<int>(runner);
+    add_type<std::string>(runner);
+    add_type<blob64>(runner);
+
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ranges>
+#include "../vector.h"
+
+
+/*
+    Сравнение std::copy / std::ranges::copy / std::find над итераторами vector и над сырыми указателями.
+
+    Функции помечены noinline, чтобы их код можно было сравнить напрямую:
+        objdump -d -C --no-show-raw-insn iterator_copy_benchmark | grep -A30 '<copy_'
+    Версии над указателями и ADL-версии (copy(...) без std::) вызывают memmove; std::copy и std::ranges::copy над
+    base_iterator в libstdc++ остаются поэлементным циклом (см. комментарий в iterator.h). Таймеры ниже показывают, во что
+    это обходится на больших массивах.
+*/
+
+
+using iterator = vector<int>::iterator;
+using const_iterator = vector<int>::const_iterator;
+
+
+__attribute__((noinline)) int* copy_raw(const int* first, const int* last, int* out) {
+    return std::copy(first, last, out);
+}
+
+__attribute__((noinline)) iterator copy_std(const_iterator first, const_iterator last, iterator out) {
+    return std::copy(first, last, out);
+}
+
+__attribute__((noinline)) iterator copy_ranges(const_iterator first, const_iterator last, iterator out) {
+    return std::ranges::copy(first, last, out).out;
+}
+
+__attribute__((noinline)) iterator copy_adl(const_iterator first, const_iterator last, iterator out) {
+    return copy(first, last, out);
+}
+
+__attribute__((noinline)) const int* find_raw(const int* first, const int* last, int value) {
+    return std::find(first, last, value);
+}
+
+__attribute__((noinline)) const_iterator find_std(const_iterator first, const_iterator last, int value) {
+    return std::find(first, last, value);
+}
+
+__attribute__((noinline)) const_iterator find_adl(const_iterator first, const_iterator last, int value) {
+    return find(first, last, value);
+}
+
+
+template <typename F>
+double measure_ns_per_element(std::size_t n, std::size_t reps, F&& f) {
+    f();
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < reps; ++i) {
+        f();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(reps * n);
+}
+
+
+int main() {
+    const std::size_t n = 1 << 20;
+    const std::size_t reps = 200;
+
+    vector<int> src(n, 1);
+    vector<int> dst(n, 0);
+    src[n - 1] = 2;
+
+    const int* raw_first = src.data();
+    const int* raw_last = src.data() + n;
+    volatile std::ptrdiff_t sink = 0;
+
+    std::cout << "copy, ns/element\n";
+    std::cout << "  raw pointers        " << measure_ns_per_element(n, reps, [&] { copy_raw(raw_first, raw_last, dst.data()); }) << '\n';
+    std::cout << "  std::copy           " << measure_ns_per_element(n, reps, [&] { copy_std(src.cbegin(), src.cend(), dst.begin()); }) << '\n';
+    std::cout << "  std::ranges::copy   " << measure_ns_per_element(n, reps, [&] { copy_ranges(src.cbegin(), src.cend(), dst.begin()); }) << '\n';
+    std::cout << "  copy (ADL)          " << measure_ns_per_element(n, reps, [&] { copy_adl(src.cbegin(), src.cend(), dst.begin()); }) << '\n';
+
+    std::cout << "find, ns/element\n";
+    std::cout << "  raw pointers        " << measure_ns_per_element(n, reps, [&] { sink = find_raw(raw_first, raw_last, 2) - raw_first; }) << '\n';
+    std::cout << "  std::find           " << measure_ns_per_element(n, reps, [&] { sink = find_std(src.cbegin(), src.cend(), 2) - src.cbegin(); }) << '\n';
+    std::cout << "  find (ADL)          " << measure_ns_per_element(n, reps, [&] { sink = find_adl(src.cbegin(), src.cend(), 2) - src.cbegin(); }) << '\n';
+
+    return sink == static_cast<std::ptrdiff_t>(n - 1) ? 0 : 1;
+}
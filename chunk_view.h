@@ -0,0 +1,393 @@
+#pragma once
+#include <iostream>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include "iterator.h"
+
+
+/*
+    Представления для блочной обработки вектора.
+
+    strided_view - каждый stride-й элемент диапазона (например, один канал из перемежающихся данных). Итератор хранит базовый
+    итератор, номер шага и сам шаг, поэтому никогда не выходит за конец массива, даже если длина не кратна шагу.
+
+    chunk_view<T, Width, Align> - разбиение непрерывного диапазона на блоки std::span<T, Width> фиксированной ширины для
+    SIMD-ядер:
+        prologue() - скалярные элементы до первого адреса, выровненного на Align (чтобы блоки читались выровненными загрузками);
+        begin()/end() - полные блоки по Width элементов;
+        tail() - скалярный хвост, который не набрал полного блока.
+    Если до выровненного адреса нельзя дойти целым числом элементов (sizeof(T) не делит Align), пролог пуст и блоки не
+    выровнены. По умолчанию Align = Width * sizeof(T), если это степень двойки не больше 64, иначе alignof(T) (пролога нет).
+
+    prefetch_distance - на сколько шагов вперёд (блоков для chunk_view, элементов для strided_view) при каждом продвижении
+    итератора выдаётся программная предвыборка. 0 - не выдавать. Предвыборка никогда не указывает за конец диапазона.
+*/
+
+
+template <typename T>
+inline void prefetch_ahead(T* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (std::is_const_v<T>) {
+        __builtin_prefetch(ptr, 0, 3);
+    } else {
+        __builtin_prefetch(ptr, 1, 3);
+    }
+#else
+    (void)ptr;
+#endif
+}
+
+
+
+template <typename Iter>
+requires std::random_access_iterator<Iter>
+class strided_iterator {
+    public:
+
+    using value_type = std::iter_value_t<Iter>;
+    using reference = std::iter_reference_t<Iter>;
+    using difference_type = std::iter_difference_t<Iter>;
+    using iterator_category = std::random_access_iterator_tag;
+
+    private:
+
+    Iter base_{};
+    difference_type index_ = 0;
+    difference_type stride_ = 1;
+    difference_type count_ = 0;
+    difference_type prefetch_distance_ = 0;
+
+    void prefetch() const noexcept {
+        if (prefetch_distance_ > 0 && index_ + prefetch_distance_ < count_) {
+            prefetch_ahead(std::addressof(base_[(index_ + prefetch_distance_) * stride_]));
+        }
+    }
+
+    public:
+
+    constexpr strided_iterator() = default;
+
+    constexpr strided_iterator(Iter base, difference_type index, difference_type stride, difference_type count,
+                               difference_type prefetch_distance = 0) noexcept
+    : base_(base), index_(index), stride_(stride), count_(count), prefetch_distance_(prefetch_distance) {}
+
+    constexpr reference operator*() const {
+        return base_[index_ * stride_];
+    }
+
+    constexpr reference operator[](difference_type n) const {
+        return base_[(index_ + n) * stride_];
+    }
+
+    constexpr strided_iterator& operator++() noexcept {
+        ++index_;
+        prefetch();
+        return *this;
+    }
+
+    constexpr strided_iterator operator++(int) noexcept {
+        strided_iterator copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    constexpr strided_iterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    constexpr strided_iterator operator--(int) noexcept {
+        strided_iterator copy = *this;
+        --index_;
+        return copy;
+    }
+
+    constexpr strided_iterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        prefetch();
+        return *this;
+    }
+
+    constexpr strided_iterator& operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    constexpr strided_iterator operator+(difference_type n) const noexcept {
+        strided_iterator copy = *this;
+        copy.index_ += n;
+        return copy;
+    }
+
+    friend constexpr strided_iterator operator+(difference_type n, const strided_iterator& it) noexcept {
+        return it + n;
+    }
+
+    constexpr strided_iterator operator-(difference_type n) const noexcept {
+        strided_iterator copy = *this;
+        copy.index_ -= n;
+        return copy;
+    }
+
+    constexpr difference_type operator-(const strided_iterator& other) const noexcept {
+        return index_ - other.index_;
+    }
+
+    constexpr bool operator==(const strided_iterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+    constexpr std::strong_ordering operator<=>(const strided_iterator& other) const noexcept {
+        return index_ <=> other.index_;
+    }
+};
+
+
+template <typename Iter>
+class strided_view {
+    using difference_type = std::iter_difference_t<Iter>;
+
+    Iter first_;
+    difference_type stride_;
+    difference_type count_;
+    difference_type prefetch_distance_;
+
+    static constexpr difference_type checked_stride(difference_type stride) {
+        if (stride <= 0) {
+            throw std::invalid_argument("strided_view: stride must be positive");
+        }
+        return stride;
+    }
+
+    public:
+
+    using iterator = strided_iterator<Iter>;
+
+    // Элементы first, first + stride, first + 2 * stride, ... строго до last; stride > 0, иначе std::invalid_argument
+    constexpr strided_view(Iter first, Iter last, difference_type stride, difference_type prefetch_distance = 0)
+    : first_(first), stride_(checked_stride(stride)), count_(first < last ? (last - first + stride_ - 1) / stride_ : 0),
+      prefetch_distance_(prefetch_distance) {}
+
+    constexpr iterator begin() const noexcept {
+        return iterator(first_, 0, stride_, count_, prefetch_distance_);
+    }
+
+    constexpr iterator end() const noexcept {
+        return iterator(first_, count_, stride_, count_, prefetch_distance_);
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return static_cast<std::size_t>(count_);
+    }
+
+    constexpr bool empty() const noexcept {
+        return count_ == 0;
+    }
+
+    constexpr decltype(auto) operator[](difference_type i) const {
+        return first_[i * stride_];
+    }
+};
+
+
+// strided(v, 3, 1) - элементы v[1], v[4], v[7], ...
+template <typename Container>
+auto strided(Container& c, std::ptrdiff_t stride, std::ptrdiff_t offset = 0, std::ptrdiff_t prefetch_distance = 0) {
+    if (offset < 0) {
+        throw std::invalid_argument("strided: offset must be non-negative");
+    }
+    auto first = c.begin();
+    auto last = c.end();
+    if (offset > last - first) {
+        offset = last - first;
+    }
+    return strided_view<decltype(first)>(first + offset, last, stride, prefetch_distance);
+}
+
+
+
+template <typename T, std::size_t Width>
+constexpr std::size_t default_chunk_alignment() noexcept {
+    constexpr std::size_t bytes = Width * sizeof(T);
+    return std::has_single_bit(bytes) && bytes <= 64 && bytes >= alignof(T) ? bytes : alignof(T);
+}
+
+
+template <typename T, std::size_t Width, std::size_t Align = default_chunk_alignment<T, Width>()>
+class chunk_view {
+    static_assert(Width > 0);
+    static_assert(std::has_single_bit(Align), "alignment must be a power of two");
+
+    T* prologue_end_ = nullptr;
+    T* body_end_ = nullptr;
+    T* first_ = nullptr;
+    T* last_ = nullptr;
+    std::size_t prefetch_distance_ = 0;
+
+    public:
+
+    using chunk_type = std::span<T, Width>;
+    using scalar_span = std::span<T>;
+
+    class iterator {
+        T* ptr_ = nullptr;
+        T* end_ = nullptr;
+        std::size_t prefetch_distance_ = 0;
+
+        public:
+
+        using value_type = chunk_type;
+        using reference = chunk_type;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+
+        constexpr iterator() = default;
+
+        constexpr iterator(T* ptr, T* end, std::size_t prefetch_distance) noexcept
+        : ptr_(ptr), end_(end), prefetch_distance_(prefetch_distance) {}
+
+        constexpr chunk_type operator*() const noexcept {
+            return chunk_type(ptr_, Width);
+        }
+
+        constexpr chunk_type operator[](difference_type n) const noexcept {
+            return chunk_type(ptr_ + n * static_cast<difference_type>(Width), Width);
+        }
+
+        constexpr iterator& operator++() noexcept {
+            ptr_ += Width;
+            if (prefetch_distance_ != 0 && static_cast<std::size_t>(end_ - ptr_) > prefetch_distance_ * Width) {
+                prefetch_ahead(ptr_ + prefetch_distance_ * Width);
+            }
+            return *this;
+        }
+
+        constexpr iterator operator++(int) noexcept {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        constexpr iterator& operator--() noexcept {
+            ptr_ -= Width;
+            return *this;
+        }
+
+        constexpr iterator operator--(int) noexcept {
+            iterator copy = *this;
+            ptr_ -= Width;
+            return copy;
+        }
+
+        constexpr iterator& operator+=(difference_type n) noexcept {
+            ptr_ += n * static_cast<difference_type>(Width);
+            return *this;
+        }
+
+        constexpr iterator& operator-=(difference_type n) noexcept {
+            ptr_ -= n * static_cast<difference_type>(Width);
+            return *this;
+        }
+
+        constexpr iterator operator+(difference_type n) const noexcept {
+            iterator copy = *this;
+            return copy += n;
+        }
+
+        friend constexpr iterator operator+(difference_type n, const iterator& it) noexcept {
+            return it + n;
+        }
+
+        constexpr iterator operator-(difference_type n) const noexcept {
+            iterator copy = *this;
+            return copy -= n;
+        }
+
+        constexpr difference_type operator-(const iterator& other) const noexcept {
+            return (ptr_ - other.ptr_) / static_cast<difference_type>(Width);
+        }
+
+        constexpr bool operator==(const iterator& other) const noexcept {
+            return ptr_ == other.ptr_;
+        }
+
+        constexpr std::strong_ordering operator<=>(const iterator& other) const noexcept {
+            return std::compare_three_way()(ptr_, other.ptr_);
+        }
+    };
+
+
+    constexpr chunk_view() = default;
+
+    chunk_view(T* first, T* last, std::size_t prefetch_distance = 0) noexcept
+    : first_(first), last_(last), prefetch_distance_(prefetch_distance) {
+        std::size_t n = static_cast<std::size_t>(last - first);
+
+        std::size_t misalignment = reinterpret_cast<std::uintptr_t>(first) % Align;
+        std::size_t skip_bytes = misalignment == 0 ? 0 : Align - misalignment;
+        std::size_t prologue = skip_bytes % sizeof(T) == 0 ? skip_bytes / sizeof(T) : 0;
+        if (prologue > n) {
+            prologue = n;
+        }
+
+        prologue_end_ = first + prologue;
+        body_end_ = prologue_end_ + (n - prologue) / Width * Width;
+    }
+
+    template <bool B, typename U, typename Ptr>
+    chunk_view(base_iterator<B, U, Ptr> first, base_iterator<B, U, Ptr> last, std::size_t prefetch_distance = 0) noexcept
+    : chunk_view(std::to_address(first), std::to_address(last), prefetch_distance) {}
+
+    template <typename Container>
+    requires requires (Container& c) { { c.data() } -> std::convertible_to<T*>; c.size(); }
+    explicit chunk_view(Container& c, std::size_t prefetch_distance = 0) noexcept
+    : chunk_view(c.data(), c.data() + c.size(), prefetch_distance) {}
+
+    scalar_span prologue() const noexcept {
+        return scalar_span(first_, prologue_end_);
+    }
+
+    iterator begin() const noexcept {
+        if (prefetch_distance_ != 0 && static_cast<std::size_t>(body_end_ - prologue_end_) > prefetch_distance_ * Width) {
+            prefetch_ahead(prologue_end_ + prefetch_distance_ * Width);
+        }
+        return iterator(prologue_end_, body_end_, prefetch_distance_);
+    }
+
+    iterator end() const noexcept {
+        return iterator(body_end_, body_end_, prefetch_distance_);
+    }
+
+    scalar_span tail() const noexcept {
+        return scalar_span(body_end_, last_);
+    }
+
+    // Количество полных блоков
+    std::size_t size() const noexcept {
+        return static_cast<std::size_t>(body_end_ - prologue_end_) / Width;
+    }
+
+    /*
+        Обходит весь диапазон: scalar(T&) - для элементов пролога и хвоста, block(span<T, Width>) - для полных блоков.
+        Порядок элементов сохраняется.
+    */
+    template <typename ScalarFn, typename BlockFn>
+    void for_each(ScalarFn&& scalar, BlockFn&& block) const {
+        for (T& x : prologue()) {
+            scalar(x);
+        }
+        for (chunk_type chunk : *this) {
+            block(chunk);
+        }
+        for (T& x : tail()) {
+            scalar(x);
+        }
+    }
+};
@@ -0,0 +1,528 @@
+#pragma once
+#include <iostream>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+/*
+    incremental_vector - вектор с постепенным перевыделением памяти.
+
+    Обычный vector при удвоении в emplace_back переносит все элементы за один вызов: для 100 млн элементов это одна очень
+    долгая операция посреди потока обработки запросов. Здесь при росте выделяется новый буфер вдвое большей ёмкости, но
+    старые элементы остаются на месте; каждая следующая изменяющая операция (push_back, emplace_back, pop_back) переносит
+    не больше migration_step элементов. Новые элементы сразу конструируются в новом буфере - до переноса, потому что
+    аргумент может ссылаться на ещё не перенесённый элемент (push_back(v[0])).
+
+    Пока перенос не закончен, элемент i лежит в новом буфере, если он уже перенесён (i < migrated_) или добавлен после
+    роста (i >= old_size_), и в старом - иначе; operator[] выбирает буфер одним сравнением. Новый буфер вдвое больше, поэтому
+    перенос заведомо заканчивается раньше, чем понадобится следующий рост, - на одну операцию никогда не приходится больше
+    migration_step переносов плюс одно конструирование.
+
+    Исключение из шага переноса в emplace_back не отменяет уже сделанную вставку: шаг повторится при следующей операции.
+    Если из-за таких исключений перенос не успел закончиться к росту, emplace_back сначала строит новое значение во
+    временном объекте (аргументы могут ссылаться на элементы старого буфера), затем дописывает перенос и только потом растёт.
+
+    Платой за это служит отсутствие непрерывности: data() нет, итераторы - индексные (random access, не contiguous).
+    reserve, shrink_to_fit и копирование переносят всё сразу, как обычный vector. finish_migration() завершает перенос
+    явно, например в момент простоя.
+*/
+template <typename T, typename Alloc = std::allocator<T>>
+class incremental_vector {
+    using traits = std::allocator_traits<Alloc>;
+
+    public:
+
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = typename traits::pointer;
+
+    static constexpr size_type default_migration_step = 16;
+
+    private:
+
+    pointer arr_ = nullptr;
+    size_type sz_ = 0;
+    size_type cap_ = 0;
+
+    // Старый буфер, из которого ещё не всё перенесено
+    pointer old_arr_ = nullptr;
+    size_type old_size_ = 0;
+    size_type old_cap_ = 0;
+    size_type migrated_ = 0;
+
+    size_type migration_step_ = default_migration_step;
+    [[no_unique_address]] Alloc alloc_;
+
+
+    T* slot(size_type i) const noexcept {
+        if (old_arr_ != nullptr && i >= migrated_ && i < old_size_) {
+            return std::to_address(old_arr_ + i);
+        }
+        return std::to_address(arr_ + i);
+    }
+
+    void release_old() noexcept {
+        traits::deallocate(alloc_, old_arr_, old_cap_);
+        old_arr_ = nullptr;
+        old_size_ = 0;
+        old_cap_ = 0;
+        migrated_ = 0;
+    }
+
+    // Переносит до count элементов из старого буфера в новый
+    void migrate(size_type count) {
+        if (old_arr_ == nullptr) {
+            return;
+        }
+        size_type stop = old_size_ - migrated_ > count ? migrated_ + count : old_size_;
+        for (; migrated_ < stop; ++migrated_) {
+            traits::construct(alloc_, std::to_address(arr_ + migrated_), std::move_if_noexcept(old_arr_[migrated_]));
+            traits::destroy(alloc_, std::to_address(old_arr_ + migrated_));
+        }
+        if (migrated_ == old_size_) {
+            release_old();
+        }
+    }
+
+    /*
+        Рост: новый буфер вдвое больше, старые элементы остаются на месте. Обычно к этому моменту перенос уже закончен
+        (каждое добавление переносит хотя бы один элемент), finish_migration() нужен на случай брошенного шага переноса.
+    */
+    void grow() {
+        finish_migration();
+        size_type new_cap = cap_ != 0 ? cap_ * 2 : 1;
+        if (new_cap > max_size()) {
+            throw std::length_error("incremental_vector::grow");
+        }
+        pointer new_arr = traits::allocate(alloc_, new_cap);
+
+        old_arr_ = arr_;
+        old_size_ = sz_;
+        old_cap_ = cap_;
+        migrated_ = 0;
+        arr_ = new_arr;
+        cap_ = new_cap;
+
+        if (old_size_ == 0) {
+            release_old();
+        }
+    }
+
+    // Все элементы в один новый буфер ёмкости new_cap
+    void relocate(size_type new_cap) {
+        finish_migration();
+        pointer new_arr = traits::allocate(alloc_, new_cap);
+        size_type i = 0;
+        try {
+            for (; i < sz_; ++i) {
+                traits::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
+            }
+        } catch (...) {
+            for (size_type j = 0; j < i; ++j) {
+                traits::destroy(alloc_, std::to_address(new_arr + j));
+            }
+            traits::deallocate(alloc_, new_arr, new_cap);
+            throw;
+        }
+        for (size_type j = 0; j < sz_; ++j) {
+            traits::destroy(alloc_, std::to_address(arr_ + j));
+        }
+        traits::deallocate(alloc_, arr_, cap_);
+        arr_ = new_arr;
+        cap_ = new_cap;
+    }
+
+    void destroy_all() noexcept {
+        for (size_type i = 0; i < sz_; ++i) {
+            traits::destroy(alloc_, slot(i));
+        }
+        if (old_arr_ != nullptr) {
+            release_old();
+        }
+        sz_ = 0;
+    }
+
+
+    template <bool IsConst>
+    class index_iterator {
+        using container = std::conditional_t<IsConst, const incremental_vector, incremental_vector>;
+
+        public:
+
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using iterator_category = std::random_access_iterator_tag;
+
+        private:
+
+        container* owner_ = nullptr;
+        difference_type index_ = 0;
+
+        public:
+
+        index_iterator() = default;
+        index_iterator(container* owner, difference_type index) noexcept : owner_(owner), index_(index) {}
+
+        operator index_iterator<true>() const noexcept {
+            return index_iterator<true>(owner_, index_);
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[static_cast<size_type>(index_)];
+        }
+
+        pointer operator->() const noexcept {
+            return std::addressof(**this);
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*owner_)[static_cast<size_type>(index_ + n)];
+        }
+
+        index_iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        index_iterator operator++(int) noexcept {
+            index_iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        index_iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        index_iterator operator--(int) noexcept {
+            index_iterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        index_iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        index_iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        index_iterator operator+(difference_type n) const noexcept {
+            return index_iterator(owner_, index_ + n);
+        }
+
+        friend index_iterator operator+(difference_type n, const index_iterator& it) noexcept {
+            return it + n;
+        }
+
+        index_iterator operator-(difference_type n) const noexcept {
+            return index_iterator(owner_, index_ - n);
+        }
+
+        difference_type operator-(const index_iterator& other) const noexcept {
+            return index_ - other.index_;
+        }
+
+        bool operator==(const index_iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+        std::strong_ordering operator<=>(const index_iterator& other) const noexcept {
+            return index_ <=> other.index_;
+        }
+    };
+
+    public:
+
+    using iterator = index_iterator<false>;
+    using const_iterator = index_iterator<true>;
+
+
+
+    // Constructors
+
+    explicit incremental_vector(size_type migration_step = default_migration_step, const Alloc& alloc = Alloc())
+    : migration_step_(migration_step != 0 ? migration_step : 1), alloc_(alloc) {}
+
+    incremental_vector(const incremental_vector& other)
+    : migration_step_(other.migration_step_), alloc_(traits::select_on_container_copy_construction(other.alloc_)) {
+        if (other.sz_ == 0) {
+            return;
+        }
+        arr_ = traits::allocate(alloc_, other.sz_);
+        cap_ = other.sz_;
+        try {
+            for (; sz_ < other.sz_; ++sz_) {
+                traits::construct(alloc_, std::to_address(arr_ + sz_), other[sz_]);
+            }
+        } catch (...) {
+            destroy_all();
+            traits::deallocate(alloc_, arr_, cap_);
+            throw;
+        }
+    }
+
+    incremental_vector(incremental_vector&& other) noexcept
+    : arr_(std::exchange(other.arr_, nullptr)), sz_(std::exchange(other.sz_, 0)), cap_(std::exchange(other.cap_, 0)),
+      old_arr_(std::exchange(other.old_arr_, nullptr)), old_size_(std::exchange(other.old_size_, 0)),
+      old_cap_(std::exchange(other.old_cap_, 0)), migrated_(std::exchange(other.migrated_, 0)),
+      migration_step_(other.migration_step_), alloc_(std::move(other.alloc_)) {}
+
+
+
+    // Destructor
+
+    ~incremental_vector() {
+        destroy_all();
+        traits::deallocate(alloc_, arr_, cap_);
+    }
+
+
+
+    // Assignment
+
+    incremental_vector& operator=(const incremental_vector& other) {
+        if (this != &other) {
+            incremental_vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    incremental_vector& operator=(incremental_vector&& other) noexcept {
+        if (this != &other) {
+            incremental_vector moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+
+
+    // Element access
+
+    reference operator[](size_type i) noexcept {
+        return *slot(i);
+    }
+
+    const_reference operator[](size_type i) const noexcept {
+        return *slot(i);
+    }
+
+    reference at(size_type i) {
+        if (i >= sz_) {
+            throw std::out_of_range("incremental_vector::at");
+        }
+        return *slot(i);
+    }
+
+    const_reference at(size_type i) const {
+        if (i >= sz_) {
+            throw std::out_of_range("incremental_vector::at");
+        }
+        return *slot(i);
+    }
+
+    reference front() noexcept {
+        return *slot(0);
+    }
+
+    const_reference front() const noexcept {
+        return *slot(0);
+    }
+
+    reference back() noexcept {
+        return *slot(sz_ - 1);
+    }
+
+    const_reference back() const noexcept {
+        return *slot(sz_ - 1);
+    }
+
+
+
+    // Iterators
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, static_cast<difference_type>(sz_));
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, static_cast<difference_type>(sz_));
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+
+
+    // Capacity
+
+    size_type size() const noexcept {
+        return sz_;
+    }
+
+    bool empty() const noexcept {
+        return sz_ == 0;
+    }
+
+    size_type capacity() const noexcept {
+        return cap_;
+    }
+
+    size_type max_size() const noexcept {
+        return traits::max_size(alloc_);
+    }
+
+    // Переносит всё сразу, поэтому не ограничена по времени
+    void reserve(size_type new_cap) {
+        if (new_cap <= cap_) {
+            return;
+        }
+        if (new_cap > max_size()) {
+            throw std::length_error("incremental_vector::reserve");
+        }
+        relocate(new_cap);
+    }
+
+    void shrink_to_fit() {
+        if (sz_ < cap_) {
+            relocate(sz_);
+        }
+    }
+
+
+
+    // Migration
+
+    bool is_migrating() const noexcept {
+        return old_arr_ != nullptr;
+    }
+
+    // Сколько элементов ещё лежит в старом буфере
+    size_type pending_migration() const noexcept {
+        return old_arr_ != nullptr ? old_size_ - migrated_ : 0;
+    }
+
+    size_type migration_step() const noexcept {
+        return migration_step_;
+    }
+
+    void set_migration_step(size_type step) noexcept {
+        migration_step_ = step != 0 ? step : 1;
+    }
+
+    // Продвигает перенос на count элементов - например, когда поток простаивает
+    void migrate_some(size_type count) {
+        migrate(count);
+    }
+
+    void finish_migration() {
+        if (old_arr_ != nullptr) {
+            migrate(old_size_ - migrated_);
+        }
+    }
+
+
+
+    // Modifiers
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (sz_ == cap_ && old_arr_ != nullptr) {
+            // Перенос отстал: аргументы могут ссылаться на неперенесённые элементы, которые finish_migration() разрушит
+            T value(std::forward<Args>(args)...);
+            grow();
+            traits::construct(alloc_, std::to_address(arr_ + sz_), std::move(value));
+        } else {
+            if (sz_ == cap_) {
+                grow();
+            }
+            traits::construct(alloc_, std::to_address(arr_ + sz_), std::forward<Args>(args)...);
+        }
+        ++sz_;
+        try {
+            migrate(migration_step_);
+        } catch (...) {
+            // Элемент уже вставлен; неперенесённый элемент остался в старом буфере, шаг повторится в следующий раз
+        }
+        return arr_[sz_ - 1];
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() {
+        migrate(migration_step_);
+        --sz_;
+        traits::destroy(alloc_, slot(sz_));
+        // Удалённый элемент мог быть последним неперенесённым
+        if (old_arr_ != nullptr && old_size_ > sz_) {
+            old_size_ = sz_;
+            if (migrated_ >= old_size_) {
+                release_old();
+            }
+        }
+    }
+
+    void clear() noexcept {
+        destroy_all();
+    }
+
+    void swap(incremental_vector& other) noexcept {
+        std::swap(arr_, other.arr_);
+        std::swap(sz_, other.sz_);
+        std::swap(cap_, other.cap_);
+        std::swap(old_arr_, other.old_arr_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(old_cap_, other.old_cap_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(migration_step_, other.migration_step_);
+        if constexpr (traits::propagate_on_container_swap::value) {
+            std::swap(alloc_, other.alloc_);
+        }
+    }
+
+    allocator_type get_allocator() const {
+        return alloc_;
+    }
+};
+
+
+template <typename T, typename Alloc>
+void swap(incremental_vector<T, Alloc>& lhs, incremental_vector<T, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 
 /*
@@ -9,6 +12,12 @@
 
 
 
+    Третий параметр - тип указателя, который хранит итератор. По умолчанию это T*, но если аллокатор вектора использует
+    "причудливые" указатели (например, offset_ptr), то итератор хранит именно их, а константная версия получает
+    pointer_traits<Ptr>::rebind<const T>.
+
+
+
     Важно! Если у вас есть собственный итератор, вы можете определить в нём вложенные типы (iterator_category, value_type, difference_type,
     pointer, reference), и тогда iterator_traits автоматически их подхватит.
 */
@@ -32,14 +41,16 @@ using conditional_t = typename conditional<IsConst, T,  U>::type;
 
 
 
-template <bool IsConst, typename T>
+template <bool IsConst, typename T, typename Ptr = T*>
 class base_iterator {
     public:
 
     using value_type = T;
-    using pointer = conditional_t<IsConst, const T*, T*>;
+    using element_type = conditional_t<IsConst, const T, T>;
+    using pointer = conditional_t<IsConst, typename std::pointer_traits<Ptr>::template rebind<const T>, Ptr>;
     using reference = conditional_t<IsConst, const T&, T&>;
-    using iterator_category = std::contiguous_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::contiguous_iterator_tag;
     using difference_type = std::ptrdiff_t;
 
     private:
@@ -48,92 +59,92 @@ class base_iterator {
  
     public:
     /*
-    Эта строка говорит компилятору: Я разрешаю всем инстанциациям шаблона base_iterator<B, U> доступ к моим приватным членам
+    Эта строка говорит компилятору: Я разрешаю всем инстанциациям шаблона base_iterator<B, U, P> доступ к моим приватным членам
     */
-    template <bool B, typename U>
+    template <bool B, typename U, typename P>
     friend class base_iterator;
 
     constexpr base_iterator() noexcept : ptr(nullptr) {}
-    base_iterator(pointer ptr_) noexcept : ptr(ptr_) {}
+    constexpr base_iterator(pointer ptr_) noexcept : ptr(ptr_) {}
 
     template <bool B = IsConst>
     requires(B)
-    base_iterator(const base_iterator<false, T>& other) noexcept : ptr(other.ptr) {}
-    base_iterator(const base_iterator&) noexcept = default;
+    constexpr base_iterator(const base_iterator<false, T, Ptr>& other) noexcept : ptr(other.ptr) {}
+    constexpr base_iterator(const base_iterator&) noexcept = default;
 
 
     template <bool B = IsConst>
     requires(B)
-    base_iterator& operator=(const base_iterator<false, T>& other) noexcept {
+    constexpr base_iterator& operator=(const base_iterator<false, T, Ptr>& other) noexcept {
         ptr = other.ptr;
         return *this;
     }
-    base_iterator& operator=(const base_iterator&) noexcept = default;
+    constexpr base_iterator& operator=(const base_iterator&) noexcept = default;
 
 
-    [[nodiscard]] reference operator*() const noexcept { 
+    [[nodiscard]] constexpr reference operator*() const noexcept { 
         return *ptr; 
     }
 
-    [[nodiscard]] reference operator[](difference_type n) const noexcept {
+    [[nodiscard]] constexpr reference operator[](difference_type n) const noexcept {
         return *(ptr + n);
     }
 
     // Компилятор сам допишет ещё одну стрелочку к возвращаемому объекту
-    [[nodiscard]] pointer operator->() const noexcept {
+    [[nodiscard]] constexpr pointer operator->() const noexcept {
         return ptr;
     }
 
 
-    base_iterator& operator++() noexcept { 
+    constexpr base_iterator& operator++() noexcept { 
         ++ptr;
         return *this;
     }
 
-    base_iterator operator++(int) noexcept {
+    constexpr base_iterator operator++(int) noexcept {
         base_iterator copy = *this;
         ++ptr;
         return copy;
     }
 
-    base_iterator& operator--() noexcept { 
+    constexpr base_iterator& operator--() noexcept { 
         --ptr;
         return *this;
     }
 
-    base_iterator operator--(int) noexcept {
+    constexpr base_iterator operator--(int) noexcept {
         base_iterator copy = *this;
         --ptr;
         return copy;
     }
 
     template <bool B>
-    bool operator==(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator==(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr == other.ptr;
     }
 
     template <bool B>
-    bool operator!=(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator!=(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr != other.ptr;
     }
 
     template <bool B>
-    bool operator>(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator>(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr > other.ptr;
     }
 
     template <bool B>
-    bool operator>=(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator>=(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr >= other.ptr;
     }
 
     template <bool B>
-    bool operator<(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator<(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr < other.ptr;
     }
 
     template <bool B>
-    bool operator<=(const base_iterator<B, T>& other) const noexcept {
+    constexpr bool operator<=(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr <= other.ptr;
     }
 
@@ -143,27 +154,100 @@ class base_iterator {
 //  bool operator<=>(const OtherIter& other) const noexcept = default;
 
 
-    base_iterator& operator+=(difference_type n) noexcept {
+    constexpr base_iterator& operator+=(difference_type n) noexcept {
         ptr += n;
         return *this;
     }
 
-    base_iterator operator+(difference_type n) const noexcept {
+    constexpr base_iterator operator+(difference_type n) const noexcept {
         return base_iterator(ptr + n);
     }
 
-    base_iterator& operator-=(difference_type n) noexcept {
+    constexpr base_iterator& operator-=(difference_type n) noexcept {
         ptr -= n;
         return *this;
     }
 
-    base_iterator operator-(difference_type n) const noexcept {
+    constexpr base_iterator operator-(difference_type n) const noexcept {
         return base_iterator(ptr - n);
     }
 
-    std::ptrdiff_t operator-(const base_iterator& other) const noexcept {
+    // Для sized_sentinel_for разность должна считаться и между iterator и const_iterator
+    template <bool B>
+    constexpr difference_type operator-(const base_iterator<B, T, Ptr>& other) const noexcept {
         return ptr - other.ptr;
     }
 
-    ~base_iterator() = default;
-};
\ No newline at end of file
+    friend constexpr base_iterator operator+(difference_type n, const base_iterator& it) noexcept {
+        return it + n;
+    }
+
+    constexpr ~base_iterator() = default;
+};
+
+
+
+/*
+    Требования std::contiguous_iterator: iterator_concept = contiguous_iterator_tag, element_type, n + it, разность
+    итераторов и std::to_address (он берётся через operator->, а для причудливых указателей раскрывается рекурсивно).
+    iterator_category при этом random_access - как у итераторов std::vector, старые алгоритмы про contiguous не знают.
+*/
+static_assert(std::contiguous_iterator<base_iterator<false, int>>);
+static_assert(std::contiguous_iterator<base_iterator<true, int>>);
+static_assert(std::sized_sentinel_for<base_iterator<true, int>, base_iterator<false, int>>);
+
+
+
+/*
+    libstdc++ (по крайней мере до GCC 14) разворачивает в указатели только собственный __normal_iterator, поэтому
+    std::copy(v.begin(), v.end(), out) и std::ranges::copy для нашего итератора идут поэлементным циклом вместо memmove, а
+    std::find - без развёрнутого цикла. libc++ и MSVC STL разворачивают любой contiguous_iterator сами.
+
+    Ниже - перегрузки самых частых алгоритмов, которые находятся по ADL при неквалифицированном вызове (copy(...), а не
+    std::copy(...)): они переводят base_iterator в обычные указатели через std::to_address, вызывают std-алгоритм на них
+    и заворачивают результат обратно. Перегрузки более специализированы, чем std::copy, так что выбираются и тогда, когда ADL
+    находит std (например, с std::back_inserter в качестве выхода). Сравнение кода - в benchmarks/iterator_copy.cpp.
+*/
+template <typename It>
+constexpr auto unwrap_iterator(It it) noexcept {
+    if constexpr (std::contiguous_iterator<It> && !std::is_pointer_v<It>) {
+        return std::to_address(it);
+    } else {
+        return it;
+    }
+}
+
+template <typename It, typename Unwrapped>
+constexpr It rewrap_iterator(It origin, Unwrapped result) noexcept {
+    if constexpr (std::is_same_v<It, Unwrapped>) {
+        return result;
+    } else {
+        return origin + (result - unwrap_iterator(origin));
+    }
+}
+
+
+template <bool B, typename T, typename Ptr, typename OutIt>
+constexpr OutIt copy(base_iterator<B, T, Ptr> first, base_iterator<B, T, Ptr> last, OutIt out) {
+    return rewrap_iterator(out, std::copy(unwrap_iterator(first), unwrap_iterator(last), unwrap_iterator(out)));
+}
+
+template <bool B, typename T, typename Ptr, typename Size, typename OutIt>
+constexpr OutIt copy_n(base_iterator<B, T, Ptr> first, Size count, OutIt out) {
+    return rewrap_iterator(out, std::copy_n(unwrap_iterator(first), count, unwrap_iterator(out)));
+}
+
+template <bool B, typename T, typename Ptr, typename OutIt>
+constexpr OutIt copy_backward(base_iterator<B, T, Ptr> first, base_iterator<B, T, Ptr> last, OutIt out) {
+    return rewrap_iterator(out, std::copy_backward(unwrap_iterator(first), unwrap_iterator(last), unwrap_iterator(out)));
+}
+
+template <typename T, typename Ptr, typename U>
+constexpr void fill(base_iterator<false, T, Ptr> first, base_iterator<false, T, Ptr> last, const U& value) {
+    std::fill(unwrap_iterator(first), unwrap_iterator(last), value);
+}
+
+template <bool B, typename T, typename Ptr, typename U>
+constexpr base_iterator<B, T, Ptr> find(base_iterator<B, T, Ptr> first, base_iterator<B, T, Ptr> last, const U& value) {
+    return rewrap_iterator(first, std::find(unwrap_iterator(first), unwrap_iterator(last), value));
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+
+/*
+    offset_ptr<T> - "причудливый" (fancy) указатель, который хранит не адрес, а смещение от собственного адреса до объекта.
+    Если и сам offset_ptr, и объект лежат в одном и том же отображённом в память сегменте, то значение остаётся корректным
+    независимо от того, по какому адресу этот сегмент отображён в конкретном процессе. Именно такой указатель должен
+    возвращать аллокатор, если контейнер (например, наш vector) живёт в разделяемой памяти.
+
+    Следствия из такого представления:
+    - копирование и присваивание нельзя делать побайтово, смещение пересчитывается относительно нового адреса;
+    - смещение 0 означало бы указатель на самого себя, поэтому нулевой указатель кодируется смещением 1
+      (указатель на байт внутри самого offset_ptr нам никогда не нужен).
+*/
+
+
+template <typename T>
+class offset_ptr {
+    static constexpr std::ptrdiff_t null_offset = 1;
+
+    std::ptrdiff_t offset_;
+
+    void set(const volatile void* p) noexcept {
+        if (p == nullptr) {
+            offset_ = null_offset;
+        } else {
+            offset_ = reinterpret_cast<std::uintptr_t>(p) - reinterpret_cast<std::uintptr_t>(this);
+        }
+    }
+
+    public:
+
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = std::add_lvalue_reference_t<T>;
+    using iterator_category = std::random_access_iterator_tag;
+
+    template <typename U>
+    using rebind = offset_ptr<U>;
+
+    template <typename U>
+    friend class offset_ptr;
+
+
+
+    // Constructors
+
+    offset_ptr() noexcept : offset_(null_offset) {}
+
+    offset_ptr(std::nullptr_t) noexcept : offset_(null_offset) {}
+
+    offset_ptr(T* p) noexcept {
+        set(p);
+    }
+
+    offset_ptr(const offset_ptr& other) noexcept {
+        set(other.get());
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    offset_ptr(const offset_ptr<U>& other) noexcept {
+        set(static_cast<T*>(other.get()));
+    }
+
+    // Нужен allocator_traits для перехода от void_pointer к pointer
+    template <typename U>
+    requires (!std::convertible_to<U*, T*> && std::is_void_v<std::remove_cv_t<U>>)
+    explicit offset_ptr(const offset_ptr<U>& other) noexcept {
+        set(static_cast<T*>(other.get()));
+    }
+
+    template <typename U = T>
+    requires (!std::is_void_v<U>)
+    static offset_ptr pointer_to(U& r) noexcept {
+        return offset_ptr(std::addressof(r));
+    }
+
+
+
+    // Assignment
+
+    offset_ptr& operator=(const offset_ptr& other) noexcept {
+        set(other.get());
+        return *this;
+    }
+
+    offset_ptr& operator=(T* p) noexcept {
+        set(p);
+        return *this;
+    }
+
+    offset_ptr& operator=(std::nullptr_t) noexcept {
+        offset_ = null_offset;
+        return *this;
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    offset_ptr& operator=(const offset_ptr<U>& other) noexcept {
+        set(static_cast<T*>(other.get()));
+        return *this;
+    }
+
+
+
+    // Observers
+
+    T* get() const noexcept {
+        if (offset_ == null_offset) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(reinterpret_cast<std::uintptr_t>(this) + offset_);
+    }
+
+    T* operator->() const noexcept {
+        return get();
+    }
+
+    template <typename U = T>
+    requires (!std::is_void_v<U>)
+    U& operator*() const noexcept {
+        return *get();
+    }
+
+    template <typename U = T>
+    requires (!std::is_void_v<U>)
+    U& operator[](difference_type n) const noexcept {
+        return get()[n];
+    }
+
+    explicit operator bool() const noexcept {
+        return offset_ != null_offset;
+    }
+
+
+
+    // Arithmetic
+
+    offset_ptr& operator+=(difference_type n) noexcept {
+        set(get() + n);
+        return *this;
+    }
+
+    offset_ptr& operator-=(difference_type n) noexcept {
+        set(get() - n);
+        return *this;
+    }
+
+    offset_ptr& operator++() noexcept {
+        return *this += 1;
+    }
+
+    offset_ptr operator++(int) noexcept {
+        offset_ptr copy = *this;
+        *this += 1;
+        return copy;
+    }
+
+    offset_ptr& operator--() noexcept {
+        return *this -= 1;
+    }
+
+    offset_ptr operator--(int) noexcept {
+        offset_ptr copy = *this;
+        *this -= 1;
+        return copy;
+    }
+
+    friend offset_ptr operator+(const offset_ptr& p, difference_type n) noexcept {
+        return offset_ptr(p.get() + n);
+    }
+
+    friend offset_ptr operator+(difference_type n, const offset_ptr& p) noexcept {
+        return offset_ptr(p.get() + n);
+    }
+
+    friend offset_ptr operator-(const offset_ptr& p, difference_type n) noexcept {
+        return offset_ptr(p.get() - n);
+    }
+
+    template <typename U>
+    friend difference_type operator-(const offset_ptr& lhs, const offset_ptr<U>& rhs) noexcept {
+        return lhs.get() - rhs.get();
+    }
+
+
+
+    // Comparison
+
+    template <typename U>
+    friend bool operator==(const offset_ptr& lhs, const offset_ptr<U>& rhs) noexcept {
+        return lhs.get() == rhs.get();
+    }
+
+    friend bool operator==(const offset_ptr& lhs, std::nullptr_t) noexcept {
+        return !lhs;
+    }
+
+    template <typename U>
+    friend auto operator<=>(const offset_ptr& lhs, const offset_ptr<U>& rhs) noexcept {
+        return std::compare_three_way()(lhs.get(), rhs.get());
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include "thread_pool.h"
+
+
+/*
+    Параллельные циклы над диапазонами с произвольным доступом (base_iterator нашего vector'а, указатели и т. п.).
+
+    Разбиение адаптивное ("lazy binary splitting"): поток обрабатывает свой диапазон кусками по grain элементов и перед
+    каждым куском смотрит в свою очередь пула. Если она пуста - соседям нечего красть, и поток отдаёт им правую половину
+    оставшегося диапазона отдельной задачей. Если в очереди уже лежит неукраденная работа - все заняты, и дробить дальше
+    бессмысленно. Так число задач подстраивается под реальную загрузку, а не под число потоков: при равномерной работе задач
+    порядка числа потоков, при неравномерной - дробятся только "тяжёлые" участки.
+
+    grain = 0 выбирает размер куска автоматически (около восьми кусков на поток).
+*/
+
+
+inline std::size_t parallel_grain(std::size_t count, std::size_t grain, const thread_pool& pool) noexcept {
+    if (grain != 0) {
+        return grain;
+    }
+    return std::max<std::size_t>(1, count / (pool.size() * 8));
+}
+
+
+// Вызывает body(sub_first, sub_last) на непересекающихся кусках [first, last)
+template <typename RandomIt, typename Body>
+requires std::random_access_iterator<RandomIt>
+void parallel_for_split(thread_pool& pool, RandomIt first, RandomIt last, std::size_t grain, Body& body) {
+    task_group group(pool);
+
+    while (first != last) {
+        std::size_t count = static_cast<std::size_t>(last - first);
+        if (count > 2 * grain && pool.local_backlog() == 0) {
+            RandomIt middle = first + static_cast<std::ptrdiff_t>(count / 2);
+            group.run([&pool, middle, last, grain, &body] {
+                parallel_for_split(pool, middle, last, grain, body);
+            });
+            last = middle;
+            continue;
+        }
+        RandomIt stop = first + static_cast<std::ptrdiff_t>(std::min(grain, count));
+        body(first, stop);
+        first = stop;
+    }
+
+    group.wait();
+}
+
+
+/*
+    fn вызывается либо для каждого элемента (fn(T&)), либо для куска целиком (fn(first, last)) - второй вариант удобен,
+    когда внутри куска нужен собственный векторизуемый цикл.
+*/
+template <typename RandomIt, typename Function>
+requires std::random_access_iterator<RandomIt>
+void parallel_for(RandomIt first, RandomIt last, std::size_t grain, Function fn, thread_pool& pool = thread_pool::global()) {
+    if (first == last) {
+        return;
+    }
+    grain = parallel_grain(static_cast<std::size_t>(last - first), grain, pool);
+
+    if constexpr (std::is_invocable_v<Function&, RandomIt, RandomIt>) {
+        parallel_for_split(pool, first, last, grain, fn);
+    } else {
+        auto body = [&fn](RandomIt sub_first, RandomIt sub_last) {
+            for (; sub_first != sub_last; ++sub_first) {
+                fn(*sub_first);
+            }
+        };
+        parallel_for_split(pool, first, last, grain, body);
+    }
+}
+
+template <typename Container, typename Function>
+requires std::random_access_iterator<decltype(std::declval<Container&>().begin())>
+void parallel_for(Container& c, std::size_t grain, Function fn, thread_pool& pool = thread_pool::global()) {
+    parallel_for(c.begin(), c.end(), grain, std::move(fn), pool);
+}
+
+
+
+template <typename RandomIt, typename T, typename Reduce, typename Map>
+T parallel_reduce_split(thread_pool& pool, RandomIt first, RandomIt last, std::size_t grain,
+                        const T& identity, Reduce& reduce, Map& map) {
+    // Результаты отданных половин; deque не двигает элементы при push_back. Группа объявлена позже - разрушится раньше
+    std::deque<T> partials;
+    task_group group(pool);
+    T acc = identity;
+
+    while (first != last) {
+        std::size_t count = static_cast<std::size_t>(last - first);
+        if (count > 2 * grain && pool.local_backlog() == 0) {
+            RandomIt middle = first + static_cast<std::ptrdiff_t>(count / 2);
+            T& slot = partials.emplace_back(identity);
+            group.run([&pool, middle, last, grain, &identity, &reduce, &map, &slot] {
+                slot = parallel_reduce_split(pool, middle, last, grain, identity, reduce, map);
+            });
+            last = middle;
+            continue;
+        }
+        RandomIt stop = first + static_cast<std::ptrdiff_t>(std::min(grain, count));
+        for (; first != stop; ++first) {
+            acc = reduce(std::move(acc), map(*first));
+        }
+    }
+
+    group.wait();
+
+    // Отданные половины лежат в partials от дальней к ближней: сворачиваем в порядке элементов, ассоциативности достаточно
+    for (auto it = partials.rbegin(); it != partials.rend(); ++it) {
+        acc = reduce(std::move(acc), std::move(*it));
+    }
+    return acc;
+}
+
+
+/*
+    Свёртка reduce(reduce(identity, map(x0)), map(x1)) ... в произвольной расстановке скобок: reduce должна быть
+    ассоциативной (коммутативность не нужна - порядок элементов сохраняется), identity - её нейтральным элементом,
+    потому что с него начинается каждый кусок.
+*/
+template <typename RandomIt, typename T, typename Reduce = std::plus<>, typename Map = std::identity>
+requires std::random_access_iterator<RandomIt>
+T parallel_reduce(RandomIt first, RandomIt last, std::size_t grain, T identity, Reduce reduce = {}, Map map = {},
+                  thread_pool& pool = thread_pool::global()) {
+    if (first == last) {
+        return identity;
+    }
+    grain = parallel_grain(static_cast<std::size_t>(last - first), grain, pool);
+    return parallel_reduce_split(pool, first, last, grain, identity, reduce, map);
+}
+
+template <typename Container, typename T, typename Reduce = std::plus<>, typename Map = std::identity>
+requires std::random_access_iterator<decltype(std::declval<const Container&>().begin())>
+T parallel_reduce(const Container& c, std::size_t grain, T identity, Reduce reduce = {}, Map map = {},
+                  thread_pool& pool = thread_pool::global()) {
+    return parallel_reduce(c.begin(), c.end(), grain, std::move(identity), std::move(reduce), std::move(map), pool);
+}
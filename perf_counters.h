@@ -0,0 +1,259 @@
+#pragma once
+#include <iostream>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_LINUX 1
+#endif
+
+
+/*
+    Аппаратные счётчики производительности через perf_event_open (Linux).
+
+    perf_counters открывает по одному счётчику на событие для текущего потока (только user space): такты, инструкции,
+    промахи L1d и LLC по чтению, промахи предсказателя переходов, промахи dTLB. Счётчики открываются независимо, а не
+    группой, поэтому отсутствие одного события (в виртуалке часто нет cache-событий) не отключает остальные. Если ядро
+    мультиплексирует счётчики, значение масштабируется по time_enabled / time_running.
+
+    Когда perf недоступен (не Linux, perf_event_paranoid, контейнер без CAP_PERFMON), конструктор не бросает: соответствующие
+    события просто помечены недоступными, а available() возвращает false. Код, который меряет, ведёт себя одинаково в обоих
+    случаях.
+
+    Использование в горячем пути:
+        perf_counters counters;
+        perf_sample total;
+        for (...) {
+            perf_region region(counters, total);   // start в конструкторе, stop и накопление в total в деструкторе
+            v.insert(...);
+        }
+    start / stop - это системные вызовы (ioctl), так что область должна быть заметно дольше микросекунды.
+*/
+
+
+enum class perf_event {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    dtlb_misses
+};
+
+inline constexpr std::size_t perf_event_count = 6;
+
+constexpr std::string_view perf_event_name(perf_event event) noexcept {
+    switch (event) {
+        case perf_event::cycles: return "cycles";
+        case perf_event::instructions: return "instructions";
+        case perf_event::l1d_misses: return "l1d_misses";
+        case perf_event::llc_misses: return "llc_misses";
+        case perf_event::branch_misses: return "branch_misses";
+        case perf_event::dtlb_misses: return "dtlb_misses";
+    }
+    return "unknown";
+}
+
+
+// Значения событий; недоступные события и интервалы, в которые счётчик не работал, не помечены valid
+struct perf_sample {
+    std::array<double, perf_event_count> values{};
+    std::array<bool, perf_event_count> valid{};
+
+    double operator[](perf_event event) const noexcept {
+        return values[static_cast<std::size_t>(event)];
+    }
+
+    bool has(perf_event event) const noexcept {
+        return valid[static_cast<std::size_t>(event)];
+    }
+
+    bool empty() const noexcept {
+        for (bool v : valid) {
+            if (v) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Накопление: событие остаётся valid, только если оно было valid в обоих слагаемых (или слева ничего не было)
+    perf_sample& operator+=(const perf_sample& other) noexcept {
+        bool first = empty();
+        for (std::size_t i = 0; i < perf_event_count; ++i) {
+            values[i] += other.values[i];
+            valid[i] = (first || valid[i]) && other.valid[i];
+        }
+        return *this;
+    }
+
+    perf_sample& operator/=(double divisor) noexcept {
+        for (double& v : values) {
+            v /= divisor;
+        }
+        return *this;
+    }
+};
+
+
+
+class perf_counters {
+    std::array<int, perf_event_count> fds_;
+
+#ifdef PERF_COUNTERS_LINUX
+    struct read_format {
+        std::uint64_t value;
+        std::uint64_t time_enabled;
+        std::uint64_t time_running;
+    };
+
+    static constexpr std::uint64_t cache_miss(std::uint64_t cache) noexcept {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    static int open_event(perf_event event) noexcept {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (event) {
+            case perf_event::cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case perf_event::instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case perf_event::l1d_misses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cache_miss(PERF_COUNT_HW_CACHE_L1D);
+                break;
+            case perf_event::llc_misses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cache_miss(PERF_COUNT_HW_CACHE_LL);
+                break;
+            case perf_event::branch_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case perf_event::dtlb_misses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cache_miss(PERF_COUNT_HW_CACHE_DTLB);
+                break;
+        }
+        // Текущий поток, любой процессор
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        return static_cast<int>(fd);
+    }
+#endif
+
+    public:
+
+    perf_counters() noexcept {
+        fds_.fill(-1);
+#ifdef PERF_COUNTERS_LINUX
+        for (std::size_t i = 0; i < perf_event_count; ++i) {
+            fds_[i] = open_event(static_cast<perf_event>(i));
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters() {
+#ifdef PERF_COUNTERS_LINUX
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    // Доступно ли хотя бы одно событие
+    bool available() const noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool available(perf_event event) const noexcept {
+        return fds_[static_cast<std::size_t>(event)] >= 0;
+    }
+
+    // Обнуляет и запускает счётчики
+    void start() noexcept {
+#ifdef PERF_COUNTERS_LINUX
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Останавливает счётчики и возвращает значения с момента start()
+    perf_sample stop() noexcept {
+        perf_sample sample;
+#ifdef PERF_COUNTERS_LINUX
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (std::size_t i = 0; i < perf_event_count; ++i) {
+            if (fds_[i] < 0) {
+                continue;
+            }
+            read_format data{};
+            if (read(fds_[i], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.time_running == 0) {
+                continue;
+            }
+            double value = static_cast<double>(data.value);
+            if (data.time_running < data.time_enabled) {
+                value *= static_cast<double>(data.time_enabled) / static_cast<double>(data.time_running);
+            }
+            sample.values[i] = value;
+            sample.valid[i] = true;
+        }
+#endif
+        return sample;
+    }
+};
+
+
+
+// Область измерения: start в конструкторе, в деструкторе значения прибавляются к out
+class perf_region {
+    perf_counters& counters_;
+    perf_sample& out_;
+
+    public:
+
+    perf_region(perf_counters& counters, perf_sample& out) noexcept : counters_(counters), out_(out) {
+        counters_.start();
+    }
+
+    perf_region(const perf_region&) = delete;
+    perf_region& operator=(const perf_region&) = delete;
+
+    ~perf_region() {
+        out_ += counters_.stop();
+    }
+};
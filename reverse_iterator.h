@@ -1,4 +1,4 @@
-#pragma onсe
+#pragma once
 #include <iostream>
 #include <type_traits>
 
@@ -17,7 +17,21 @@ class reverse_iterator {
     using pointer = std::iterator_traits<Iter>::pointer;
     using reference = std::iterator_traits<Iter>::reference;
     using difference_type = std::iterator_traits<Iter>::difference_type;
-    using iterator_category = std::iterator_traits<Iter>::iterator_category;
+
+    /*
+        Обход в обратную сторону не может быть contiguous (адреса убывают), поэтому contiguous_iterator_tag базового
+        итератора понижается до random_access_iterator_tag - как и в std::reverse_iterator.
+    */
+    using iterator_category = std::conditional_t<
+        std::derived_from<typename std::iterator_traits<Iter>::iterator_category, std::random_access_iterator_tag>,
+        std::random_access_iterator_tag,
+        typename std::iterator_traits<Iter>::iterator_category
+    >;
+    using iterator_concept = std::conditional_t<
+        std::random_access_iterator<Iter>,
+        std::random_access_iterator_tag,
+        std::bidirectional_iterator_tag
+    >;
 
     private:
     Iter current;
@@ -98,7 +112,7 @@ class reverse_iterator {
         return *this;
     }
 
-    constexpr reverse_iterator operator+(difference_type n) noexcept(noexcept(current - n) && noexcept(reverse_iterator(current - n))) {
+    constexpr reverse_iterator operator+(difference_type n) const noexcept(noexcept(current - n) && noexcept(reverse_iterator(current - n))) {
         static_assert(std::derived_from<
             typename std::iterator_traits<Iter>::iterator_category,
             std::random_access_iterator_tag>);
@@ -113,13 +127,24 @@ class reverse_iterator {
         return *this;
     }
 
-    constexpr reverse_iterator operator-(difference_type n) noexcept(noexcept(current + n) && noexcept(reverse_iterator(current + n))) {
+    constexpr reverse_iterator operator-(difference_type n) const noexcept(noexcept(current + n) && noexcept(reverse_iterator(current + n))) {
         static_assert(std::derived_from<
             typename std::iterator_traits<Iter>::iterator_category,
             std::random_access_iterator_tag>);
         return reverse_iterator(current + n);
     }
 
+    template <typename OtherIter>
+    requires(requires (const Iter& x, const OtherIter& y) { y - x; })
+    constexpr difference_type operator-(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(other.base() - current)) {
+        return other.base() - current;
+    }
+
+    friend constexpr reverse_iterator operator+(difference_type n, const reverse_iterator& it) noexcept(noexcept(it + n))
+    requires std::random_access_iterator<Iter> {
+        return it + n;
+    }
+
     template <typename OtherIter>
     requires(std::is_same_v<value_type, typename std::iterator_traits<OtherIter>::value_type>)
     bool operator==(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(current == other.base())){
@@ -135,24 +160,24 @@ class reverse_iterator {
     template <typename OtherIter>
     requires(std::is_same_v<value_type, typename std::iterator_traits<OtherIter>::value_type>)
     bool operator>=(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(current == other.base())){
-        return current >= other.base();
+        return current <= other.base();
     }
 
     template <typename OtherIter>
     requires(std::is_same_v<value_type, typename std::iterator_traits<OtherIter>::value_type>)
     bool operator<=(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(current == other.base())){
-        return current <= other.base();
+        return current >= other.base();
     }
 
     template <typename OtherIter>
     requires(std::is_same_v<value_type, typename std::iterator_traits<OtherIter>::value_type>)
     bool operator>(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(current == other.base())){
-        return current > other.base();
+        return current < other.base();
     }
 
     template <typename OtherIter>
     requires(std::is_same_v<value_type, typename std::iterator_traits<OtherIter>::value_type>)
     bool operator<(const reverse_iterator<OtherIter>& other) const noexcept(noexcept(current == other.base())){
-        return current < other.base();
+        return current > other.base();
     }
 };
\ No newline at end of file
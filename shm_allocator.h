@@ -0,0 +1,257 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "offset_ptr.h"
+
+
+/*
+    Разделяемая память через shm_open + mmap и аллокатор поверх неё.
+
+    Сценарий использования: один процесс создаёт сегмент, строит в нём большой vector (сам объект vector тоже кладётся в сегмент
+    через construct_root), а рабочие процессы открывают сегмент только на чтение и работают с тем же вектором без копирования.
+    Сегмент в разных процессах может быть отображён по разным адресам, поэтому все указатели внутри него - offset_ptr.
+
+    Внутри сегмента живёт shm_arena - простой монотонный (bump) аллокатор. Освобождение возвращает память только если блок
+    был выделен последним - этого хватает, чтобы vector при росте не терял предыдущий буфер, а для read-only данных, которые
+    строятся один раз, более сложный аллокатор не нужен.
+*/
+
+
+class shm_arena {
+    static constexpr std::uint64_t magic_value = 0x6d795f73746c5f73;  // "my_stl_s"
+
+    std::uint64_t magic_;
+    std::size_t size_;
+    std::atomic<std::size_t> top_;
+    offset_ptr<void> root_;
+
+    static_assert(std::atomic<std::size_t>::is_always_lock_free, "atomic in shared memory must be address-free");
+
+    public:
+
+    shm_arena(std::size_t size) noexcept : magic_(magic_value), size_(size), top_(sizeof(shm_arena)), root_(nullptr) {}
+
+    bool valid() const noexcept {
+        return magic_ == magic_value;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    std::size_t used() const noexcept {
+        return top_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] void* allocate(std::size_t bytes, std::size_t alignment) {
+        std::size_t top = top_.load(std::memory_order_relaxed);
+        std::size_t begin;
+        do {
+            begin = (top + alignment - 1) & ~(alignment - 1);
+            if (begin + bytes > size_ || begin + bytes < begin) {
+                throw std::bad_alloc();
+            }
+        } while (!top_.compare_exchange_weak(top, begin + bytes, std::memory_order_relaxed));
+        return reinterpret_cast<char*>(this) + begin;
+    }
+
+    void deallocate(void* ptr, std::size_t bytes) noexcept {
+        std::size_t end = static_cast<char*>(ptr) - reinterpret_cast<char*>(this) + bytes;
+        std::size_t begin = end - bytes;
+        top_.compare_exchange_strong(end, begin, std::memory_order_relaxed);
+    }
+
+    void* root() const noexcept {
+        return root_.get();
+    }
+
+    void set_root(void* ptr) noexcept {
+        root_ = ptr;
+    }
+};
+
+
+
+class shared_memory_segment {
+    std::string name_;
+    void* base_;
+    std::size_t size_;
+
+    shared_memory_segment(std::string name, void* base, std::size_t size) noexcept : name_(std::move(name)), base_(base), size_(size) {}
+
+    static void* map(int fd, std::size_t size, bool read_only) {
+        void* base = ::mmap(nullptr, size, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        ::close(fd);
+        return base;
+    }
+
+    public:
+
+    // Создаёт (или пересоздаёт) сегмент заданного размера и размещает в его начале shm_arena
+    static shared_memory_segment create(const std::string& name, std::size_t size) {
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd == -1) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate");
+        }
+
+        void* base = map(fd, size, false);
+        new (base) shm_arena(size);
+        return shared_memory_segment(name, base, size);
+    }
+
+    static shared_memory_segment open(const std::string& name, bool read_only = true) {
+        int fd = ::shm_open(name.c_str(), read_only ? O_RDONLY : O_RDWR, 0);
+        if (fd == -1) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* base = map(fd, size, read_only);
+        if (size < sizeof(shm_arena) || !static_cast<shm_arena*>(base)->valid()) {
+            ::munmap(base, size);
+            throw std::runtime_error("shared memory segment " + name + " is not initialized");
+        }
+        return shared_memory_segment(name, base, size);
+    }
+
+    static void remove(const std::string& name) noexcept {
+        ::shm_unlink(name.c_str());
+    }
+
+    shared_memory_segment(const shared_memory_segment&) = delete;
+    shared_memory_segment& operator=(const shared_memory_segment&) = delete;
+
+    shared_memory_segment(shared_memory_segment&& other) noexcept
+    : name_(std::move(other.name_)), base_(std::exchange(other.base_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    shared_memory_segment& operator=(shared_memory_segment&& other) noexcept {
+        if (this != &other) {
+            if (base_) {
+                ::munmap(base_, size_);
+            }
+            name_ = std::move(other.name_);
+            base_ = std::exchange(other.base_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~shared_memory_segment() {
+        if (base_) {
+            ::munmap(base_, size_);
+        }
+    }
+
+    const std::string& name() const noexcept {
+        return name_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    shm_arena& arena() const noexcept {
+        return *static_cast<shm_arena*>(base_);
+    }
+
+    // Создаёт корневой объект сегмента, по которому его найдут другие процессы
+    template <typename T, typename ... Args>
+    T* construct_root(Args&& ... args) {
+        void* ptr = arena().allocate(sizeof(T), alignof(T));
+        T* object = new (ptr) T(std::forward<Args>(args) ...);
+        arena().set_root(object);
+        return object;
+    }
+
+    template <typename T>
+    T* root() const noexcept {
+        return static_cast<T*>(arena().root());
+    }
+};
+
+
+
+template <typename T>
+class shm_allocator {
+    offset_ptr<shm_arena> arena_;
+
+    public:
+
+    using value_type = T;
+    using pointer = offset_ptr<T>;
+    using const_pointer = offset_ptr<const T>;
+    using void_pointer = offset_ptr<void>;
+    using const_void_pointer = offset_ptr<const void>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = shm_allocator<U>;
+    };
+
+    template <typename U>
+    friend class shm_allocator;
+
+    shm_allocator(shm_arena& arena) noexcept : arena_(&arena) {}
+
+    shm_allocator(const shared_memory_segment& segment) noexcept : arena_(&segment.arena()) {}
+
+    shm_allocator(const shm_allocator& other) noexcept = default;
+
+    template <typename U>
+    shm_allocator(const shm_allocator<U>& other) noexcept : arena_(other.arena_) {}
+
+    [[nodiscard]] pointer allocate(size_type count) {
+        return pointer(static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T))));
+    }
+
+    void deallocate(pointer ptr, size_type count) noexcept {
+        if (ptr) {
+            arena_->deallocate(ptr.get(), count * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const shm_allocator<U>& other) const noexcept {
+        return arena_ == other.arena_;
+    }
+
+    template <typename U>
+    bool operator!=(const shm_allocator<U>& other) const noexcept {
+        return arena_ != other.arena_;
+    }
+};
@@ -0,0 +1,526 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#endif
+
+
+/*
+    Векторизованные find / count / contains / min / max / sum для непрерывных диапазонов int32_t и float.
+
+    Реализации для AVX2 и SSE4.2 собраны с __attribute__((target(...))), поэтому весь проект по-прежнему компилируется под
+    базовый x86-64, а нужная версия выбирается при первом вызове по CPUID (__builtin_cpu_supports) и запоминается в таблице
+    указателей на функции. На других архитектурах и на старых процессорах работает переносимая скалярная версия.
+
+    Принимается любой непрерывный диапазон: vector, его const-вариант, span, массив. find возвращает итератор этого же
+    диапазона.
+
+    Отличия от скалярного прохода, о которых стоит помнить:
+    - sum для float суммирует по дорожкам и складывает их в конце - порядок сложений другой, последние биты результата могут
+      отличаться от std::accumulate; sum для int32_t возвращает int64_t и не переполняется;
+    - find / count для float сравнивают через ==: NaN не находится, -0.0 равен +0.0;
+    - min / max для float при наличии NaN дают неопределённый (но один из элементов) результат;
+    - min / max пустого диапазона бросают std::invalid_argument.
+*/
+
+
+enum class simd_level {
+    scalar,
+    sse42,
+    avx2
+};
+
+
+template <typename T>
+struct simd_kernel_table {
+    std::size_t (*find)(const T* data, std::size_t n, T value) noexcept;
+    std::size_t (*count)(const T* data, std::size_t n, T value) noexcept;
+    T (*min)(const T* data, std::size_t n) noexcept;
+    T (*max)(const T* data, std::size_t n) noexcept;
+    std::conditional_t<std::is_integral_v<T>, std::int64_t, T> (*sum)(const T* data, std::size_t n) noexcept;
+};
+
+
+
+// Переносимые версии; они же дочищают хвосты векторных
+template <typename T>
+struct scalar_kernels {
+    using sum_type = std::conditional_t<std::is_integral_v<T>, std::int64_t, T>;
+
+    static std::size_t find(const T* data, std::size_t n, T value) noexcept {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    static std::size_t count(const T* data, std::size_t n, T value) noexcept {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            result += data[i] == value;
+        }
+        return result;
+    }
+
+    static T min(const T* data, std::size_t n) noexcept {
+        T result = data[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            result = data[i] < result ? data[i] : result;
+        }
+        return result;
+    }
+
+    static T max(const T* data, std::size_t n) noexcept {
+        T result = data[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            result = result < data[i] ? data[i] : result;
+        }
+        return result;
+    }
+
+    static sum_type sum(const T* data, std::size_t n) noexcept {
+        sum_type result = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            result += data[i];
+        }
+        return result;
+    }
+
+    static constexpr simd_kernel_table<T> table{&find, &count, &min, &max, &sum};
+};
+
+
+
+#ifdef SIMD_KERNELS_X86
+
+struct sse42_kernels {
+    // int32_t
+
+    __attribute__((target("sse4.2,popcnt")))
+    static std::size_t find(const std::int32_t* data, std::size_t n, std::int32_t value) noexcept {
+        __m128i needle = _mm_set1_epi32(value);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle);
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + scalar_kernels<std::int32_t>::find(data + i, n - i, value);
+    }
+
+    __attribute__((target("sse4.2,popcnt")))
+    static std::size_t count(const std::int32_t* data, std::size_t n, std::int32_t value) noexcept {
+        __m128i needle = _mm_set1_epi32(value);
+        std::size_t result = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle);
+            result += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq)))));
+        }
+        return result + scalar_kernels<std::int32_t>::count(data + i, n - i, value);
+    }
+
+    __attribute__((target("sse4.2")))
+    static std::int32_t min(const std::int32_t* data, std::size_t n) noexcept {
+        if (n < 4) {
+            return scalar_kernels<std::int32_t>::min(data, n);
+        }
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm_min_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        }
+        alignas(16) std::int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        std::int32_t result = scalar_kernels<std::int32_t>::min(lanes, 4);
+        return i == n ? result : std::min(result, scalar_kernels<std::int32_t>::min(data + i, n - i));
+    }
+
+    __attribute__((target("sse4.2")))
+    static std::int32_t max(const std::int32_t* data, std::size_t n) noexcept {
+        if (n < 4) {
+            return scalar_kernels<std::int32_t>::max(data, n);
+        }
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm_max_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        }
+        alignas(16) std::int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        std::int32_t result = scalar_kernels<std::int32_t>::max(lanes, 4);
+        return i == n ? result : std::max(result, scalar_kernels<std::int32_t>::max(data + i, n - i));
+    }
+
+    __attribute__((target("sse4.2")))
+    static std::int64_t sum(const std::int32_t* data, std::size_t n) noexcept {
+        __m128i acc = _mm_setzero_si128();
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+        }
+        alignas(16) std::int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[0] + lanes[1] + scalar_kernels<std::int32_t>::sum(data + i, n - i);
+    }
+
+
+    // float
+
+    __attribute__((target("sse4.2,popcnt")))
+    static std::size_t find(const float* data, std::size_t n, float value) noexcept {
+        __m128 needle = _mm_set1_ps(value);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), needle));
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + scalar_kernels<float>::find(data + i, n - i, value);
+    }
+
+    __attribute__((target("sse4.2,popcnt")))
+    static std::size_t count(const float* data, std::size_t n, float value) noexcept {
+        __m128 needle = _mm_set1_ps(value);
+        std::size_t result = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), needle));
+            result += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask)));
+        }
+        return result + scalar_kernels<float>::count(data + i, n - i, value);
+    }
+
+    __attribute__((target("sse4.2")))
+    static float min(const float* data, std::size_t n) noexcept {
+        if (n < 4) {
+            return scalar_kernels<float>::min(data, n);
+        }
+        __m128 acc = _mm_loadu_ps(data);
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm_min_ps(acc, _mm_loadu_ps(data + i));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        float result = scalar_kernels<float>::min(lanes, 4);
+        return i == n ? result : std::min(result, scalar_kernels<float>::min(data + i, n - i));
+    }
+
+    __attribute__((target("sse4.2")))
+    static float max(const float* data, std::size_t n) noexcept {
+        if (n < 4) {
+            return scalar_kernels<float>::max(data, n);
+        }
+        __m128 acc = _mm_loadu_ps(data);
+        std::size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm_max_ps(acc, _mm_loadu_ps(data + i));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        float result = scalar_kernels<float>::max(lanes, 4);
+        return i == n ? result : std::max(result, scalar_kernels<float>::max(data + i, n - i));
+    }
+
+    __attribute__((target("sse4.2")))
+    static float sum(const float* data, std::size_t n) noexcept {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(data + i));
+            acc1 = _mm_add_ps(acc1, _mm_loadu_ps(data + i + 4));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar_kernels<float>::sum(data + i, n - i);
+    }
+
+
+    template <typename T>
+    static constexpr simd_kernel_table<T> table{
+        static_cast<std::size_t (*)(const T*, std::size_t, T) noexcept>(&find),
+        static_cast<std::size_t (*)(const T*, std::size_t, T) noexcept>(&count),
+        static_cast<T (*)(const T*, std::size_t) noexcept>(&min),
+        static_cast<T (*)(const T*, std::size_t) noexcept>(&max),
+        static_cast<std::conditional_t<std::is_integral_v<T>, std::int64_t, T> (*)(const T*, std::size_t) noexcept>(&sum)
+    };
+};
+
+
+
+struct avx2_kernels {
+    // int32_t
+
+    __attribute__((target("avx2,popcnt,bmi")))
+    static std::size_t find(const std::int32_t* data, std::size_t n, std::int32_t value) noexcept {
+        __m256i needle = _mm256_set1_epi32(value);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + scalar_kernels<std::int32_t>::find(data + i, n - i, value);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    static std::size_t count(const std::int32_t* data, std::size_t n, std::int32_t value) noexcept {
+        __m256i needle = _mm256_set1_epi32(value);
+        std::size_t result = 0;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle);
+            result += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)))));
+        }
+        return result + scalar_kernels<std::int32_t>::count(data + i, n - i, value);
+    }
+
+    __attribute__((target("avx2")))
+    static std::int32_t min(const std::int32_t* data, std::size_t n) noexcept {
+        if (n < 8) {
+            return scalar_kernels<std::int32_t>::min(data, n);
+        }
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        std::size_t i = 8;
+        for (; i + 8 <= n; i += 8) {
+            acc = _mm256_min_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        }
+        alignas(32) std::int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        std::int32_t result = scalar_kernels<std::int32_t>::min(lanes, 8);
+        return i == n ? result : std::min(result, scalar_kernels<std::int32_t>::min(data + i, n - i));
+    }
+
+    __attribute__((target("avx2")))
+    static std::int32_t max(const std::int32_t* data, std::size_t n) noexcept {
+        if (n < 8) {
+            return scalar_kernels<std::int32_t>::max(data, n);
+        }
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        std::size_t i = 8;
+        for (; i + 8 <= n; i += 8) {
+            acc = _mm256_max_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        }
+        alignas(32) std::int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        std::int32_t result = scalar_kernels<std::int32_t>::max(lanes, 8);
+        return i == n ? result : std::max(result, scalar_kernels<std::int32_t>::max(data + i, n - i));
+    }
+
+    __attribute__((target("avx2")))
+    static std::int64_t sum(const std::int32_t* data, std::size_t n) noexcept {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+            acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4))));
+        }
+        alignas(32) std::int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_kernels<std::int32_t>::sum(data + i, n - i);
+    }
+
+
+    // float
+
+    __attribute__((target("avx2,popcnt,bmi")))
+    static std::size_t find(const float* data, std::size_t n, float value) noexcept {
+        __m256 needle = _mm256_set1_ps(value);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), needle, _CMP_EQ_OQ));
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+            }
+        }
+        return i + scalar_kernels<float>::find(data + i, n - i, value);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    static std::size_t count(const float* data, std::size_t n, float value) noexcept {
+        __m256 needle = _mm256_set1_ps(value);
+        std::size_t result = 0;
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), needle, _CMP_EQ_OQ));
+            result += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask)));
+        }
+        return result + scalar_kernels<float>::count(data + i, n - i, value);
+    }
+
+    __attribute__((target("avx2")))
+    static float min(const float* data, std::size_t n) noexcept {
+        if (n < 8) {
+            return scalar_kernels<float>::min(data, n);
+        }
+        __m256 acc = _mm256_loadu_ps(data);
+        std::size_t i = 8;
+        for (; i + 8 <= n; i += 8) {
+            acc = _mm256_min_ps(acc, _mm256_loadu_ps(data + i));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        float result = scalar_kernels<float>::min(lanes, 8);
+        return i == n ? result : std::min(result, scalar_kernels<float>::min(data + i, n - i));
+    }
+
+    __attribute__((target("avx2")))
+    static float max(const float* data, std::size_t n) noexcept {
+        if (n < 8) {
+            return scalar_kernels<float>::max(data, n);
+        }
+        __m256 acc = _mm256_loadu_ps(data);
+        std::size_t i = 8;
+        for (; i + 8 <= n; i += 8) {
+            acc = _mm256_max_ps(acc, _mm256_loadu_ps(data + i));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        float result = scalar_kernels<float>::max(lanes, 8);
+        return i == n ? result : std::max(result, scalar_kernels<float>::max(data + i, n - i));
+    }
+
+    __attribute__((target("avx2")))
+    static float sum(const float* data, std::size_t n) noexcept {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+            acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+        float result = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        return result + scalar_kernels<float>::sum(data + i, n - i);
+    }
+
+
+    template <typename T>
+    static constexpr simd_kernel_table<T> table{
+        static_cast<std::size_t (*)(const T*, std::size_t, T) noexcept>(&find),
+        static_cast<std::size_t (*)(const T*, std::size_t, T) noexcept>(&count),
+        static_cast<T (*)(const T*, std::size_t) noexcept>(&min),
+        static_cast<T (*)(const T*, std::size_t) noexcept>(&max),
+        static_cast<std::conditional_t<std::is_integral_v<T>, std::int64_t, T> (*)(const T*, std::size_t) noexcept>(&sum)
+    };
+};
+
+#endif
+
+
+
+// Лучший уровень, который поддерживает текущий процессор
+inline simd_level detect_simd_level() noexcept {
+#ifdef SIMD_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi")) {
+        return simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        return simd_level::sse42;
+    }
+#endif
+    return simd_level::scalar;
+}
+
+// Таблица для конкретного уровня (для тестов и бенчмарков); уровень выше поддерживаемого сборкой даёт скалярную версию
+template <typename T>
+requires std::is_same_v<T, std::int32_t> || std::is_same_v<T, float>
+constexpr const simd_kernel_table<T>& simd_kernels_for(simd_level level) noexcept {
+#ifdef SIMD_KERNELS_X86
+    switch (level) {
+        case simd_level::avx2:
+            return avx2_kernels::table<T>;
+        case simd_level::sse42:
+            return sse42_kernels::table<T>;
+        case simd_level::scalar:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    return scalar_kernels<T>::table;
+}
+
+// Таблица, выбранная по CPUID при первом обращении
+template <typename T>
+const simd_kernel_table<T>& simd_kernels() noexcept {
+    static const simd_kernel_table<T>& table = simd_kernels_for<T>(detect_simd_level());
+    return table;
+}
+
+
+
+template <typename R>
+concept simd_kernel_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                            (std::is_same_v<std::ranges::range_value_t<R>, std::int32_t> ||
+                             std::is_same_v<std::ranges::range_value_t<R>, float>);
+
+
+// Итератор на первый элемент, равный value, или end
+template <simd_kernel_range R>
+auto simd_find(R&& range, std::ranges::range_value_t<R> value) {
+    using T = std::ranges::range_value_t<R>;
+    std::size_t n = std::ranges::size(range);
+    std::size_t index = simd_kernels<T>().find(std::ranges::data(range), n, value);
+    return std::ranges::begin(range) + static_cast<std::ranges::range_difference_t<R>>(index);
+}
+
+template <simd_kernel_range R>
+bool simd_contains(R&& range, std::ranges::range_value_t<R> value) {
+    using T = std::ranges::range_value_t<R>;
+    std::size_t n = std::ranges::size(range);
+    return simd_kernels<T>().find(std::ranges::data(range), n, value) != n;
+}
+
+template <simd_kernel_range R>
+std::size_t simd_count(R&& range, std::ranges::range_value_t<R> value) {
+    using T = std::ranges::range_value_t<R>;
+    return simd_kernels<T>().count(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <simd_kernel_range R>
+std::ranges::range_value_t<R> simd_min(R&& range) {
+    using T = std::ranges::range_value_t<R>;
+    if (std::ranges::empty(range)) {
+        throw std::invalid_argument("simd_min: empty range");
+    }
+    return simd_kernels<T>().min(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <simd_kernel_range R>
+std::ranges::range_value_t<R> simd_max(R&& range) {
+    using T = std::ranges::range_value_t<R>;
+    if (std::ranges::empty(range)) {
+        throw std::invalid_argument("simd_max: empty range");
+    }
+    return simd_kernels<T>().max(std::ranges::data(range), std::ranges::size(range));
+}
+
+// Для int32_t - сумма в int64_t
+template <simd_kernel_range R>
+auto simd_sum(R&& range) {
+    using T = std::ranges::range_value_t<R>;
+    return simd_kernels<T>().sum(std::ranges::data(range), std::ranges::size(range));
+}
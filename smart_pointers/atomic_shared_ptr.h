@@ -0,0 +1,205 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include "shared_ptr.h"
+
+
+/*
+    atomic_shared_ptr<T> - lock-free аналог std::atomic<std::shared_ptr<T>> поверх нашего блока управления.
+
+    Главная трудность: load() должен одновременно прочитать указатель на блок управления и увеличить в нём счётчик, а между
+    этими двумя действиями другой поток может заменить значение и освободить блок. Здесь используется схема с разделённым
+    (split) счётчиком ссылок:
+
+    - в одном 64-битном слове хранятся указатель на блок (младшие 48 бит - столько занимает адрес в user space на x86-64 и
+      aarch64) и "локальный" счётчик (старшие 16 бит);
+    - load() одним fetch_add увеличивает локальный счётчик - это резервирует ссылку, пока блок гарантированно жив; затем
+      увеличивает обычный (глобальный) счётчик в блоке и пытается вернуть резерв, уменьшив локальный счётчик обратно;
+    - store() / exchange() при замене слова переносят накопленный локальный счётчик в глобальный. Если читатель не успел
+      вернуть резерв (указатель в слове уже другой), то его резерв учтён в глобальном счётчике, и он просто отдаёт одну ссылку.
+
+    Читатель выполняет только атомарные операции над одним словом и над счётчиком блока, без блокировок и без выделений
+    памяти, поэтому стоимость load() не зависит от числа ядер (кроме неизбежной борьбы за одну кэш-линию).
+
+    Указатель на объект должен лежать рядом со счётчиками, а shared_ptr может указывать куда угодно (aliasing), поэтому
+    store() заворачивает сохраняемый shared_ptr в маленький holder - это тоже блок управления, который владеет исходным
+    shared_ptr. Выделение памяти происходит только при записи, что для горячей замены конфигурации несущественно.
+
+    compare_exchange сравнивает блоки управления: значения, полученные через load() этого же атомика, считаются равными
+    текущему, а shared_ptr, который когда-то был передан в store(), - нет (у него другой блок).
+*/
+
+
+template <typename T>
+class atomic_shared_ptr {
+    static_assert(sizeof(void*) == 8, "atomic_shared_ptr packs a counter into the upper 16 bits of a pointer");
+
+    using block_type = control_block<atomic_refcount>;
+
+    struct holder final : block_type {
+        shared_ptr<T> value;
+
+        explicit holder(shared_ptr<T>&& v) noexcept : value(std::move(v)) {}
+
+        void dispose() noexcept override {
+            value.reset();
+        }
+
+        void destroy() noexcept override {
+            delete this;
+        }
+    };
+
+    static constexpr std::uint64_t pointer_mask = (std::uint64_t(1) << 48) - 1;
+
+    /*
+        Локальный счётчик занимает 16 бит, то есть вмещает не больше 65535 резервов одновременно. Резерв живёт только внутри
+        одного вызова load() (несколько атомарных операций), и у потока может быть не больше одного такого вызова, поэтому
+        предел - 65535 потоков, одновременно находящихся внутри load() одного атомика. При переполнении перенос из старшего
+        бита теряется и счётчик молча обнуляется; в отладочной сборке это ловит assert в load().
+    */
+    static constexpr std::uint64_t one_local = std::uint64_t(1) << 48;
+    static constexpr std::uint64_t max_local = (std::uint64_t(1) << 16) - 1;
+
+    mutable std::atomic<std::uint64_t> word_;
+
+
+    static holder* get_holder(std::uint64_t word) noexcept {
+        return reinterpret_cast<holder*>(word & pointer_mask);
+    }
+
+    static std::uint64_t local_count(std::uint64_t word) noexcept {
+        return word >> 48;
+    }
+
+    static std::uint64_t make_word(shared_ptr<T> desired) {
+        if (!desired) {
+            return 0;
+        }
+        holder* h = new holder(std::move(desired));
+        std::uint64_t address = reinterpret_cast<std::uintptr_t>(h);
+        assert((address & ~pointer_mask) == 0 && "pointer does not fit into 48 bits");
+        return address;
+    }
+
+    // Переносит резервы читателей в глобальный счётчик. Ссылка, которой владел атомик, остаётся у вызывающего
+    static holder* take_ownership(std::uint64_t word) noexcept {
+        holder* h = get_holder(word);
+        if (h) {
+            long pending = static_cast<long>(local_count(word));
+            if (pending > 0) {
+                h->add_shared(pending);
+            }
+        }
+        return h;
+    }
+
+    static shared_ptr<T> to_shared(holder* h) noexcept {
+        if (h == nullptr) {
+            return shared_ptr<T>();
+        }
+        return shared_ptr_access::adopt<T, atomic_refcount>(h->value.get(), h);
+    }
+
+    public:
+
+    atomic_shared_ptr() noexcept : word_(0) {}
+
+    atomic_shared_ptr(std::nullptr_t) noexcept : word_(0) {}
+
+    atomic_shared_ptr(shared_ptr<T> desired) : word_(make_word(std::move(desired))) {}
+
+    atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+    atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+
+    ~atomic_shared_ptr() {
+        if (holder* h = take_ownership(word_.load(std::memory_order_acquire))) {
+            h->release_shared();
+        }
+    }
+
+    bool is_lock_free() const noexcept {
+        return word_.is_lock_free();
+    }
+
+    static constexpr bool is_always_lock_free = std::atomic<std::uint64_t>::is_always_lock_free;
+
+
+    shared_ptr<T> load() const noexcept {
+        std::uint64_t word = word_.fetch_add(one_local, std::memory_order_acquire);
+        assert(local_count(word) < max_local && "too many concurrent load() calls: local counter overflow");
+        holder* h = get_holder(word);
+        if (h == nullptr) {
+            // Для пустого значения резерв ничего не защищает, но его всё равно нужно вернуть, чтобы счётчик не переполнился
+            word += one_local;
+            while (get_holder(word) == nullptr && local_count(word) > 0) {
+                if (word_.compare_exchange_weak(word, word - one_local, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            return shared_ptr<T>();
+        }
+
+        h->add_shared();
+
+        word += one_local;
+        while (get_holder(word) == h) {
+            if (word_.compare_exchange_weak(word, word - one_local, std::memory_order_acq_rel)) {
+                return to_shared(h);
+            }
+        }
+
+        // Значение успели заменить, и наш резерв уже перенесён в глобальный счётчик - отдаём лишнюю ссылку
+        h->release_shared();
+        return to_shared(h);
+    }
+
+    void store(shared_ptr<T> desired) {
+        std::uint64_t old = word_.exchange(make_word(std::move(desired)), std::memory_order_acq_rel);
+        if (holder* h = take_ownership(old)) {
+            h->release_shared();
+        }
+    }
+
+    shared_ptr<T> exchange(shared_ptr<T> desired) {
+        std::uint64_t old = word_.exchange(make_word(std::move(desired)), std::memory_order_acq_rel);
+        return to_shared(take_ownership(old));
+    }
+
+    bool compare_exchange_strong(shared_ptr<T>& expected, shared_ptr<T> desired) {
+        block_type* expected_block = shared_ptr_access::get_control_block(expected);
+        std::uint64_t desired_word = make_word(std::move(desired));
+
+        std::uint64_t current = word_.load(std::memory_order_relaxed);
+        while (static_cast<block_type*>(get_holder(current)) == expected_block) {
+            if (word_.compare_exchange_weak(current, desired_word, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                if (holder* h = take_ownership(current)) {
+                    h->release_shared();
+                }
+                return true;
+            }
+        }
+
+        if (holder* h = get_holder(desired_word)) {
+            h->release_shared();
+        }
+        expected = load();
+        return false;
+    }
+
+    bool compare_exchange_weak(shared_ptr<T>& expected, shared_ptr<T> desired) {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+
+    operator shared_ptr<T>() const noexcept {
+        return load();
+    }
+
+    atomic_shared_ptr& operator=(shared_ptr<T> desired) {
+        store(std::move(desired));
+        return *this;
+    }
+};
@@ -0,0 +1,250 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include "unique_ptr.h"
+
+
+/*
+    Отложенное удаление в фоновом потоке.
+
+    Деструктор unique_ptr<Tree> или unique_ptr<T[]> на большой структуре может работать миллисекунды, и если это происходит
+    в потоке обработки запроса, это прямо видно в хвостах задержек. deferred_delete<T> - deleter, который не удаляет объект,
+    а отдаёт указатель сервису reclaimer; удаление выполняет его рабочий поток.
+
+    reclaimer:
+    - ограниченная MPSC очередь (кольцевой буфер с номерами последовательности в ячейках, схема Д. Вьюкова): постановка
+      в очередь - один CAS на общей позиции и запись в свою ячейку, без блокировок и выделений памяти;
+    - рабочий поток забирает до batch_size элементов за раз и удаляет их пачкой, затем отмечает их как выполненные;
+    - если очередь заполнена, производитель ждёт, пока рабочий поток освободит место (backpressure) - память, ожидающая
+      удаления, не растёт неограниченно;
+    - flush() ждёт, пока будут удалены все объекты, отправленные до вызова, - это делает завершение работы детерминированным;
+      деструктор reclaimer'а удаляет всё, что осталось в очереди.
+
+    Если deleter срабатывает в самом рабочем потоке (например, узел дерева хранит детей в unique_ptr с deferred_delete),
+    объект удаляется сразу: мы и так уже вне критического пути, а ожидание места в очереди здесь привело бы к взаимоблокировке.
+*/
+
+
+class reclaimer {
+    using destroy_function = void (*)(void*) noexcept;
+
+    struct task {
+        void* ptr;
+        destroy_function destroy;
+    };
+
+    struct alignas(64) cell {
+        std::atomic<std::size_t> sequence;
+        task value;
+    };
+
+    unique_ptr<cell[]> cells_;
+    std::size_t mask_;
+    std::size_t batch_size_;
+
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<std::size_t> completed_{0};
+    std::size_t dequeue_pos_ = 0;
+    std::atomic<std::uint32_t> signal_{0};
+    std::atomic<bool> stop_{false};
+    std::thread::id worker_id_;
+    std::thread worker_;
+
+
+    template <typename D, typename Pointer>
+    static void invoke_deleter(void* ptr) noexcept {
+        D()(static_cast<Pointer>(ptr));
+    }
+
+    bool try_push(const task& t) noexcept {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell& c = cells_[pos & mask_];
+            std::size_t seq = c.sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = t;
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t drain_batch() noexcept {
+        std::size_t n = 0;
+        while (n < batch_size_) {
+            cell& c = cells_[dequeue_pos_ & mask_];
+            if (c.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+                break;
+            }
+            task t = c.value;
+            c.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+            ++dequeue_pos_;
+            ++n;
+            t.destroy(t.ptr);
+        }
+        if (n > 0) {
+            completed_.fetch_add(n, std::memory_order_release);
+            completed_.notify_all();
+        }
+        return n;
+    }
+
+    void run() noexcept {
+        while (true) {
+            std::uint32_t seen = signal_.load(std::memory_order_acquire);
+            if (drain_batch() > 0) {
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                // Позиция уже занята производителем, но ячейка ещё не заполнена - дождёмся её
+                if (enqueue_pos_.load(std::memory_order_acquire) == dequeue_pos_) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            signal_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    public:
+
+    explicit reclaimer(std::size_t capacity = 4096, std::size_t batch_size = 64)
+    : cells_(make_unique<cell[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))),
+      mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      batch_size_(std::max<std::size_t>(batch_size, 1)) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        worker_ = std::thread([this] { run(); });
+        worker_id_ = worker_.get_id();
+    }
+
+    reclaimer(const reclaimer&) = delete;
+    reclaimer& operator=(const reclaimer&) = delete;
+
+    ~reclaimer() {
+        stop_.store(true, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_one();
+        worker_.join();
+    }
+
+    static reclaimer& global() {
+        static reclaimer instance;
+        return instance;
+    }
+
+
+    // Ставит удаление ptr в очередь; если очередь заполнена - ждёт свободного места
+    void submit(void* ptr, destroy_function destroy) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (std::this_thread::get_id() == worker_id_) {
+            destroy(ptr);
+            return;
+        }
+
+        task t{ptr, destroy};
+        while (!try_push(t)) {
+            std::size_t done = completed_.load(std::memory_order_acquire);
+            if (try_push(t)) {
+                break;
+            }
+            completed_.wait(done, std::memory_order_acquire);
+        }
+        signal_.fetch_add(1, std::memory_order_release);
+        signal_.notify_one();
+    }
+
+    // Отложенно уничтожает объект deleter'ом unique_ptr; deleter должен быть stateless - в очереди хранится только указатель
+    template <typename T, typename D>
+    requires std::is_empty_v<D> && std::default_initializable<D>
+    void retire(unique_ptr<T, D>&& ptr) noexcept {
+        using pointer = typename unique_ptr<T, D>::pointer;
+        submit(ptr.release(), &invoke_deleter<D, pointer>);
+    }
+
+    template <typename T>
+    requires (!std::is_array_v<T>)
+    void retire(T* ptr) noexcept {
+        submit(const_cast<std::remove_cv_t<T>*>(ptr), &invoke_deleter<Deleter<std::remove_cv_t<T>>, std::remove_cv_t<T>*>);
+    }
+
+    template <typename T>
+    void retire_array(T* ptr) noexcept {
+        submit(const_cast<std::remove_cv_t<T>*>(ptr), &invoke_deleter<Deleter<std::remove_cv_t<T>[]>, std::remove_cv_t<T>*>);
+    }
+
+    // Ждёт удаления всего, что было поставлено в очередь до вызова. Нельзя вызывать из самого рабочего потока
+    void flush() noexcept {
+        std::size_t target = enqueue_pos_.load(std::memory_order_acquire);
+        std::size_t done = completed_.load(std::memory_order_acquire);
+        while (done < target) {
+            completed_.wait(done, std::memory_order_acquire);
+            done = completed_.load(std::memory_order_acquire);
+        }
+    }
+
+    // Приблизительное число объектов, ожидающих удаления
+    std::size_t pending() const noexcept {
+        return enqueue_pos_.load(std::memory_order_relaxed) - completed_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+};
+
+
+
+template <typename T>
+struct deferred_delete {
+    using pointer = T*;
+    using element_type = T;
+
+    constexpr deferred_delete() noexcept = default;
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    deferred_delete(const deferred_delete<U>&) noexcept {}
+
+    void operator()(pointer ptr) const noexcept {
+        static_assert(sizeof(T) > 0);
+        reclaimer::global().retire(ptr);
+    }
+};
+
+template <typename T>
+struct deferred_delete<T[]> {
+    using pointer = T*;
+    using element_type = T;
+
+    constexpr deferred_delete() noexcept = default;
+
+    template <typename U>
+    requires std::convertible_to<U(*)[], T(*)[]>
+    deferred_delete(const deferred_delete<U[]>&) noexcept {}
+
+    void operator()(pointer ptr) const noexcept {
+        static_assert(sizeof(T) > 0);
+        reclaimer::global().retire_array(ptr);
+    }
+};
+
+
+template <typename T>
+using deferred_unique_ptr = unique_ptr<T, deferred_delete<T>>;
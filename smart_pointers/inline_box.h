@@ -0,0 +1,275 @@
+#pragma once
+#include <iostream>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "unique_ptr.h"
+
+
+/*
+    inline_box<Base, N> - владеющий полиморфный контейнер с оптимизацией малого буфера (small buffer optimization).
+
+    unique_ptr<Base> на маленький обработчик - это выделение памяти на каждый объект и лишний переход по указателю при каждом
+    вызове. inline_box хранит объект наследника прямо в себе, если он занимает не больше N байт (и выравнивание не больше Align),
+    а более крупные объекты кладёт в кучу. Указатель на Base кэшируется рядом с буфером, поэтому operator-> - это чтение
+    одного поля, а виртуальный вызов не уходит за пределы кэш-линии владельца.
+
+    Как и unique_ptr, box только перемещается. Чтобы перемещение было noexcept (и vector<inline_box> при росте перемещал, а не
+    копировал), внутри хранятся только типы с noexcept перемещением; остальные объекты уходят в кучу.
+
+    Уничтожение идёт через тип, с которым объект был создан, поэтому виртуальный деструктор у Base не обязателен (но для
+    объектов, пришедших из unique_ptr<U, E>, удаление выполняет E - как и в самом unique_ptr).
+
+    Из unique_ptr<U, E>&& box конструируется при тех же условиях, что и unique_ptr<Base> (указатель U* приводится к Base*).
+    Объект уже лежит в куче, так что box просто забирает владение: внутри хранится сам unique_ptr, а если он не помещается
+    (deleter с состоянием), - указатель на него.
+*/
+
+
+template <typename Base, std::size_t N = 4 * sizeof(void*), std::size_t Align = alignof(std::max_align_t)>
+class inline_box {
+    static_assert(N >= sizeof(void*), "inline_box needs room for at least one pointer");
+
+    struct ops_table {
+        Base* (*get)(void* storage) noexcept;
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+        bool is_inline;
+    };
+
+    template <typename H>
+    static constexpr bool fits = sizeof(H) <= N && alignof(H) <= Align && std::is_nothrow_move_constructible_v<H>;
+
+    // Как получить Base* из хранимого объекта H: сам объект наследника, unique_ptr на него или unique_ptr на unique_ptr
+    struct object_access {
+        template <typename H>
+        static Base* get(H& h) noexcept {
+            return std::addressof(h);
+        }
+    };
+
+    struct pointer_access {
+        template <typename H>
+        static Base* get(H& h) noexcept {
+            return h.get();
+        }
+    };
+
+    struct boxed_access {
+        template <typename H>
+        static Base* get(H& h) noexcept {
+            return h->get();
+        }
+    };
+
+    template <typename H, typename Access, bool IsInline>
+    struct model {
+        static H* self(void* storage) noexcept {
+            return std::launder(reinterpret_cast<H*>(storage));
+        }
+
+        static Base* get(void* storage) noexcept {
+            return Access::get(*self(storage));
+        }
+
+        static void move(void* dst, void* src) noexcept {
+            H* from = self(src);
+            ::new (dst) H(std::move(*from));
+            from->~H();
+        }
+
+        static void destroy(void* storage) noexcept {
+            self(storage)->~H();
+        }
+
+        static constexpr ops_table table{&get, &move, &destroy, IsInline};
+    };
+
+    Base* ptr_ = nullptr;
+    const ops_table* ops_ = nullptr;
+    alignas(Align) std::byte storage_[N];
+
+
+    template <typename H, typename Access, bool IsInline, typename... Args>
+    void construct(Args&&... args) {
+        ::new (static_cast<void*>(storage_)) H(std::forward<Args>(args)...);
+        ops_ = &model<H, Access, IsInline>::table;
+        ptr_ = ops_->get(storage_);
+    }
+
+    template <typename U, typename E>
+    void adopt(unique_ptr<U, E>&& p) {
+        if (!p) {
+            return;
+        }
+        using holder = unique_ptr<U, E>;
+        if constexpr (fits<holder>) {
+            construct<holder, pointer_access, false>(std::move(p));
+        } else {
+            construct<unique_ptr<holder>, boxed_access, false>(new holder(std::move(p)));
+        }
+    }
+
+    public:
+
+    using element_type = Base;
+    using pointer = Base*;
+
+    static constexpr std::size_t inline_capacity = N;
+
+    template <typename U>
+    static constexpr bool stores_inline = fits<U>;
+
+
+
+    // Constructors
+
+    constexpr inline_box() noexcept = default;
+
+    constexpr inline_box(std::nullptr_t) noexcept {}
+
+    template <typename U, typename... Args>
+    requires std::derived_from<U, Base> && std::constructible_from<U, Args&&...>
+    explicit inline_box(std::in_place_type_t<U>, Args&&... args) {
+        emplace<U>(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    requires std::derived_from<std::remove_cvref_t<U>, Base> && (!std::is_same_v<std::remove_cvref_t<U>, inline_box>)
+    inline_box(U&& value) {
+        emplace<std::remove_cvref_t<U>>(std::forward<U>(value));
+    }
+
+    template <typename U, typename E>
+    requires (!std::is_array_v<U>) && std::convertible_to<typename unique_ptr<U, E>::pointer, Base*>
+    inline_box(unique_ptr<U, E>&& p) {
+        adopt(std::move(p));
+    }
+
+    inline_box(inline_box&& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+            ptr_ = ops_->get(storage_);
+            other.ptr_ = nullptr;
+        }
+    }
+
+    inline_box(const inline_box&) = delete;
+
+
+
+    // Destructor
+
+    ~inline_box() {
+        reset();
+    }
+
+
+
+    // Assignment
+
+    inline_box& operator=(inline_box&& other) noexcept {
+        if (this != std::addressof(other)) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = std::exchange(other.ops_, nullptr);
+                ptr_ = ops_->get(storage_);
+                other.ptr_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    template <typename U, typename E>
+    requires (!std::is_array_v<U>) && std::convertible_to<typename unique_ptr<U, E>::pointer, Base*>
+    inline_box& operator=(unique_ptr<U, E>&& p) {
+        reset();
+        adopt(std::move(p));
+        return *this;
+    }
+
+    inline_box& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    inline_box& operator=(const inline_box&) = delete;
+
+
+
+    // Modifiers
+
+    // Если конструктор U бросит исключение, box останется пустым
+    template <typename U, typename... Args>
+    requires std::derived_from<U, Base> && std::constructible_from<U, Args&&...>
+    U& emplace(Args&&... args) {
+        reset();
+        if constexpr (fits<U>) {
+            construct<U, object_access, true>(std::forward<Args>(args)...);
+        } else {
+            construct<unique_ptr<U>, pointer_access, false>(new U(std::forward<Args>(args)...));
+        }
+        return static_cast<U&>(*ptr_);
+    }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+            ptr_ = nullptr;
+        }
+    }
+
+    void swap(inline_box& other) noexcept {
+        inline_box tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+
+
+    // Observers
+
+    Base* get() const noexcept {
+        return ptr_;
+    }
+
+    Base& operator*() const noexcept {
+        return *ptr_;
+    }
+
+    Base* operator->() const noexcept {
+        return ptr_;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    // true, если объект лежит в буфере box'а, а не в куче
+    bool is_inline() const noexcept {
+        return ops_ != nullptr && ops_->is_inline;
+    }
+};
+
+
+
+// Non-member functions
+
+template <typename Base, typename U, std::size_t N = 4 * sizeof(void*), typename... Args>
+inline_box<Base, N> make_inline_box(Args&&... args) {
+    return inline_box<Base, N>(std::in_place_type<U>, std::forward<Args>(args)...);
+}
+
+template <typename Base, std::size_t N, std::size_t A>
+bool operator==(const inline_box<Base, N, A>& x, std::nullptr_t) noexcept {
+    return !x;
+}
+
+template <typename Base, std::size_t N, std::size_t A>
+void swap(inline_box<Base, N, A>& lhs, inline_box<Base, N, A>& rhs) noexcept {
+    lhs.swap(rhs);
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include <iostream>
+#include <type_traits>
+#include <compare>
+#include <utility>
+#include "refcount_policy.h"
+
+
+/*
+    intrusive_ptr - указатель со счётчиком ссылок, который хранится внутри самого объекта. В отличие от shared_ptr здесь нет
+    блока управления: intrusive_ptr - это ровно один указатель, поэтому vector<intrusive_ptr<T>> такой же плотный, как
+    vector<T*>, а перемещение - это копирование слова и обнуление источника (noexcept, так что vector при реаллокации
+    перемещает элементы, а не копирует).
+
+    Связь со счётчиком - через две функции, которые ищутся по ADL:
+        void intrusive_ptr_add_ref(T* p);
+        void intrusive_ptr_release(T* p);
+    Их можно написать самостоятельно для своего типа, а можно унаследоваться от intrusive_ref_counter<T, Policy>, который
+    хранит счётчик и определяет обе функции. Policy - atomic_refcount или local_refcount из refcount_policy.h.
+*/
+
+
+template <typename Derived, typename Policy = atomic_refcount>
+class intrusive_ref_counter {
+    mutable typename Policy::counter_type refcount_{0};
+
+    protected:
+
+    constexpr intrusive_ref_counter() noexcept = default;
+
+    // Копия объекта - новый объект, на который пока никто не ссылается
+    intrusive_ref_counter(const intrusive_ref_counter&) noexcept {}
+
+    intrusive_ref_counter& operator=(const intrusive_ref_counter&) noexcept {
+        return *this;
+    }
+
+    ~intrusive_ref_counter() = default;
+
+    public:
+
+    using policy_type = Policy;
+
+    long use_count() const noexcept {
+        return Policy::load(refcount_);
+    }
+
+    friend void intrusive_ptr_add_ref(const intrusive_ref_counter* p) noexcept {
+        Policy::increment(p->refcount_);
+    }
+
+    friend void intrusive_ptr_release(const intrusive_ref_counter* p) noexcept {
+        if (Policy::decrement(p->refcount_) == 0) {
+            delete static_cast<const Derived*>(p);
+        }
+    }
+};
+
+
+
+template <typename T>
+class intrusive_ptr {
+    T* ptr_;
+
+    template <typename U>
+    friend class intrusive_ptr;
+
+    public:
+
+    using element_type = T;
+
+
+
+    // Constructors
+
+    constexpr intrusive_ptr() noexcept : ptr_(nullptr) {}
+
+    constexpr intrusive_ptr(std::nullptr_t) noexcept : ptr_(nullptr) {}
+
+    // add_ref = false - принять уже учтённую ссылку (например, полученную из detach())
+    intrusive_ptr(T* p, bool add_ref = true) : ptr_(p) {
+        if (ptr_ && add_ref) {
+            intrusive_ptr_add_ref(ptr_);
+        }
+    }
+
+    intrusive_ptr(const intrusive_ptr& other) : ptr_(other.ptr_) {
+        if (ptr_) {
+            intrusive_ptr_add_ref(ptr_);
+        }
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    intrusive_ptr(const intrusive_ptr<U>& other) : ptr_(other.ptr_) {
+        if (ptr_) {
+            intrusive_ptr_add_ref(ptr_);
+        }
+    }
+
+    intrusive_ptr(intrusive_ptr&& other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    intrusive_ptr(intrusive_ptr<U>&& other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+
+
+    // Destructor
+
+    ~intrusive_ptr() {
+        if (ptr_) {
+            intrusive_ptr_release(ptr_);
+        }
+    }
+
+
+
+    // Assignment
+
+    intrusive_ptr& operator=(const intrusive_ptr& other) {
+        intrusive_ptr(other).swap(*this);
+        return *this;
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    intrusive_ptr& operator=(const intrusive_ptr<U>& other) {
+        intrusive_ptr(other).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr& operator=(intrusive_ptr&& other) noexcept {
+        intrusive_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    template <typename U>
+    requires std::convertible_to<U*, T*>
+    intrusive_ptr& operator=(intrusive_ptr<U>&& other) noexcept {
+        intrusive_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr& operator=(T* p) {
+        intrusive_ptr(p).swap(*this);
+        return *this;
+    }
+
+
+
+    // Modifiers
+
+    void reset() noexcept {
+        intrusive_ptr().swap(*this);
+    }
+
+    void reset(T* p, bool add_ref = true) {
+        intrusive_ptr(p, add_ref).swap(*this);
+    }
+
+    // Отдаёт указатель вместе с его ссылкой, счётчик не уменьшается
+    T* detach() noexcept {
+        return std::exchange(ptr_, nullptr);
+    }
+
+    void swap(intrusive_ptr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+    }
+
+
+
+    // Observers
+
+    T* get() const noexcept {
+        return ptr_;
+    }
+
+    T& operator*() const noexcept {
+        return *ptr_;
+    }
+
+    T* operator->() const noexcept {
+        return ptr_;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+};
+
+
+
+// Non-member functions
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename U>
+bool operator==(const intrusive_ptr<T>& x, const intrusive_ptr<U>& y) noexcept {
+    return x.get() == y.get();
+}
+
+template <typename T>
+bool operator==(const intrusive_ptr<T>& x, std::nullptr_t) noexcept {
+    return x.get() == nullptr;
+}
+
+template <typename T, typename U>
+std::strong_ordering operator<=>(const intrusive_ptr<T>& x, const intrusive_ptr<U>& y) noexcept {
+    return std::compare_three_way()(x.get(), y.get());
+}
+
+template <typename T, typename U>
+intrusive_ptr<T> static_pointer_cast(const intrusive_ptr<U>& r) {
+    return intrusive_ptr<T>(static_cast<T*>(r.get()));
+}
+
+template <typename T, typename U>
+intrusive_ptr<T> dynamic_pointer_cast(const intrusive_ptr<U>& r) {
+    return intrusive_ptr<T>(dynamic_cast<T*>(r.get()));
+}
+
+template <typename T>
+void swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename CharT, typename Traits, typename T>
+std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const intrusive_ptr<T>& p) {
+    return os << p.get();
+}
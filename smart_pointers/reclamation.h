@@ -0,0 +1,556 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "unique_ptr.h"
+
+
+/*
+    Отложенное освобождение памяти (safe memory reclamation) для lock-free структур, узлами которых владеют unique_ptr.
+
+    Проблема: поток-писатель исключает узел из структуры и хочет его удалить, но другой поток-читатель мог успеть прочитать
+    указатель на этот узел и всё ещё с ним работает. Поэтому вместо немедленного удаления узел передаётся в retire(), а домен
+    удаляет его (через deleter, сохранённый в unique_ptr) только тогда, когда ни один читатель уже не может его видеть.
+
+    Реализованы две классические схемы:
+
+    epoch_domain - освобождение по эпохам. Есть глобальный номер эпохи; читатель на время работы со структурой "закрепляется"
+    (guard), записывая в свою запись номер эпохи, который он увидел. Глобальная эпоха продвигается, только когда все
+    закреплённые потоки уже видели текущую. Узел, отправленный в retire() в эпоху e, можно удалить, когда глобальная эпоха
+    достигла e + 2: к этому моменту все читатели, которые могли его видеть, вышли из критической секции. Вход и выход из
+    критической секции - это одна запись в свою кэш-линию, но один "застрявший" читатель задерживает освобождение всех узлов.
+
+    hazard_domain - hazard pointers. Читатель перед разыменованием публикует указатель в hazard-слот и проверяет, что он всё
+    ещё актуален. Удаляются все retired-узлы, которые не опубликованы ни в одном слоте. Защита адресная, поэтому
+    зависший читатель удерживает только свои узлы, но каждое чтение стоит записи в слот и полного барьера.
+
+    В обоих доменах retired-узлы копятся в списке потока и удаляются пачками, когда их становится batch_size.
+
+    Записи потоков закрепляются за потоком при первом обращении к домену и возвращаются при завершении потока, поэтому
+    домен должен пережить все потоки, которые им пользовались (обычно это глобальный объект, см. global()).
+*/
+
+
+class retired_node {
+    public:
+
+    retired_node* next = nullptr;
+    std::uint64_t epoch = 0;
+
+    virtual ~retired_node() = default;
+    virtual const void* address() const noexcept = 0;
+};
+
+
+// Удаление узла - это уничтожение хранимого unique_ptr, т.е. вызов его deleter'а
+template <typename T, typename D>
+class retired_unique_ptr final : public retired_node {
+    unique_ptr<T, D> ptr_;
+
+    public:
+
+    explicit retired_unique_ptr(unique_ptr<T, D>&& ptr) noexcept : ptr_(std::move(ptr)) {}
+
+    const void* address() const noexcept override {
+        return ptr_.get();
+    }
+};
+
+
+class retired_list {
+    retired_node* head_ = nullptr;
+    std::size_t size_ = 0;
+
+    public:
+
+    void push(retired_node* node) noexcept {
+        node->next = head_;
+        head_ = node;
+        ++size_;
+    }
+
+    void splice(retired_list& other) noexcept {
+        while (other.head_) {
+            retired_node* node = other.head_;
+            other.head_ = node->next;
+            push(node);
+        }
+        other.size_ = 0;
+    }
+
+    retired_node* take() noexcept {
+        size_ = 0;
+        return std::exchange(head_, nullptr);
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return head_ == nullptr;
+    }
+
+    // Список сначала отцепляется: деструктор узла может сам вызвать retire()
+    void destroy_all() noexcept {
+        destroy(take());
+    }
+
+    static void destroy(retired_node* node) noexcept {
+        while (node) {
+            retired_node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+};
+
+
+// Запоминает для текущего потока его запись в каждом домене и возвращает записи домену при завершении потока
+class reclamation_thread_cache {
+    struct entry {
+        void* domain;
+        void* record;
+        void (*release)(void* domain, void* record) noexcept;
+    };
+
+    std::vector<entry> entries_;
+
+    // Тривиальный флаг остаётся доступным и после уничтожения кэша (глобальный домен умирает позже thread_local'ов)
+    static bool& destroyed() noexcept {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    public:
+
+    ~reclamation_thread_cache() {
+        for (const entry& e : entries_) {
+            e.release(e.domain, e.record);
+        }
+        destroyed() = true;
+    }
+
+    static reclamation_thread_cache& local() {
+        thread_local reclamation_thread_cache cache;
+        return cache;
+    }
+
+    void* find(const void* domain) const noexcept {
+        for (const entry& e : entries_) {
+            if (e.domain == domain) {
+                return e.record;
+            }
+        }
+        return nullptr;
+    }
+
+    void add(void* domain, void* record, void (*release)(void*, void*) noexcept) {
+        entries_.push_back({domain, record, release});
+    }
+
+    // Вызывается из деструктора домена, чтобы поток не вернул запись в уже уничтоженный домен
+    static void forget(const void* domain) noexcept {
+        if (!destroyed()) {
+            std::erase_if(local().entries_, [domain](const entry& e) { return e.domain == domain; });
+        }
+    }
+};
+
+
+// Общий код доменов: список записей потоков, который только растёт, и захват свободной записи
+template <typename Record>
+class reclamation_records {
+    std::atomic<Record*> head_{nullptr};
+    std::atomic<std::size_t> size_{0};
+
+    public:
+
+    reclamation_records() = default;
+    reclamation_records(const reclamation_records&) = delete;
+    reclamation_records& operator=(const reclamation_records&) = delete;
+
+    ~reclamation_records() {
+        Record* record = head_.load(std::memory_order_acquire);
+        while (record) {
+            Record* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    Record* acquire() {
+        for (Record* record = head_.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+
+        Record* record = new Record();
+        record->in_use.store(true, std::memory_order_relaxed);
+        Record* head = head_.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!head_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return record;
+    }
+
+    std::size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (Record* record = head_.load(std::memory_order_acquire); record; record = record->next) {
+            f(*record);
+        }
+    }
+};
+
+
+
+class epoch_domain {
+    static constexpr std::uint64_t quiescent = UINT64_MAX;
+
+    struct alignas(64) record {
+        std::atomic<std::uint64_t> epoch{quiescent};
+        std::atomic<bool> in_use{false};
+        record* next = nullptr;
+        unsigned nesting = 0;
+        std::size_t retired_count = 0;
+        retired_list bags[3];
+        std::uint64_t bag_epochs[3] = {};
+    };
+
+    std::atomic<std::uint64_t> global_epoch_{0};
+    reclamation_records<record> records_;
+    std::mutex orphans_mutex_;
+    retired_list orphans_;
+    std::size_t batch_size_;
+
+
+    static void release_record(void* domain, void* rec) noexcept {
+        epoch_domain* self = static_cast<epoch_domain*>(domain);
+        record* r = static_cast<record*>(rec);
+        {
+            std::lock_guard lock(self->orphans_mutex_);
+            for (std::size_t i = 0; i < 3; ++i) {
+                for (retired_node* node = r->bags[i].take(); node;) {
+                    retired_node* next = node->next;
+                    self->orphans_.push(node);
+                    node = next;
+                }
+            }
+        }
+        r->retired_count = 0;
+        r->nesting = 0;
+        r->epoch.store(quiescent, std::memory_order_release);
+        r->in_use.store(false, std::memory_order_release);
+    }
+
+    record* local_record() {
+        reclamation_thread_cache& cache = reclamation_thread_cache::local();
+        if (void* found = cache.find(this)) {
+            return static_cast<record*>(found);
+        }
+        record* r = records_.acquire();
+        cache.add(this, r, &release_record);
+        return r;
+    }
+
+    bool try_advance() noexcept {
+        std::uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        bool all_observed = true;
+        records_.for_each([&](const record& r) {
+            std::uint64_t observed = r.epoch.load(std::memory_order_seq_cst);
+            if (observed != quiescent && observed != epoch) {
+                all_observed = false;
+            }
+        });
+        return all_observed && global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    }
+
+    void free_expired(record* r) noexcept {
+        std::uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < 3; ++i) {
+            if (!r->bags[i].empty() && r->bag_epochs[i] + 2 <= epoch) {
+                r->retired_count -= r->bags[i].size();
+                r->bags[i].destroy_all();
+            }
+        }
+
+        retired_node* expired = nullptr;
+        if (orphans_mutex_.try_lock()) {
+            retired_list keep;
+            for (retired_node* node = orphans_.take(); node;) {
+                retired_node* next = node->next;
+                if (node->epoch + 2 <= epoch) {
+                    node->next = expired;
+                    expired = node;
+                } else {
+                    keep.push(node);
+                }
+                node = next;
+            }
+            orphans_.splice(keep);
+            orphans_mutex_.unlock();
+        }
+        retired_list::destroy(expired);
+    }
+
+    public:
+
+    class guard {
+        record* record_;
+
+        public:
+
+        explicit guard(epoch_domain& domain) : record_(domain.local_record()) {
+            if (record_->nesting++ == 0) {
+                // exchange - полный барьер: чтения структуры не могут переместиться раньше публикации эпохи
+                record_->epoch.exchange(domain.global_epoch_.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            }
+        }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+
+        ~guard() {
+            if (--record_->nesting == 0) {
+                record_->epoch.store(quiescent, std::memory_order_release);
+            }
+        }
+    };
+
+
+    explicit epoch_domain(std::size_t batch_size = 64) noexcept : batch_size_(batch_size) {}
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    ~epoch_domain() {
+        reclamation_thread_cache::forget(this);
+        records_.for_each([](record& r) {
+            for (retired_list& bag : r.bags) {
+                bag.destroy_all();
+            }
+        });
+        orphans_.destroy_all();
+    }
+
+    static epoch_domain& global() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    [[nodiscard]] guard pin() {
+        return guard(*this);
+    }
+
+    template <typename T, typename D>
+    void retire(unique_ptr<T, D>&& ptr) {
+        if (!ptr) {
+            return;
+        }
+        retired_node* node = new retired_unique_ptr<T, D>(std::move(ptr));
+        record* r = local_record();
+
+        std::uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        node->epoch = epoch;
+        std::size_t index = epoch % 3;
+        if (r->bag_epochs[index] != epoch) {
+            // В этой корзине узлы эпохи не позже epoch - 3, они уже никому не видны
+            r->retired_count -= r->bags[index].size();
+            retired_node* expired = r->bags[index].take();
+            r->bag_epochs[index] = epoch;
+            retired_list::destroy(expired);
+        }
+        r->bags[index].push(node);
+
+        if (++r->retired_count >= batch_size_) {
+            collect();
+        }
+    }
+
+    // Пробует продвинуть эпоху и удаляет всё, что стало недоступно читателям
+    void collect() {
+        try_advance();
+        free_expired(local_record());
+    }
+
+    // Для завершения работы: если ни один поток не закреплён, после вызова все retired-узлы этого потока удалены
+    void synchronize() {
+        for (int i = 0; i < 3; ++i) {
+            try_advance();
+        }
+        free_expired(local_record());
+    }
+
+    std::uint64_t epoch() const noexcept {
+        return global_epoch_.load(std::memory_order_relaxed);
+    }
+};
+
+
+
+class hazard_domain {
+    struct alignas(64) slot {
+        std::atomic<const void*> pointer{nullptr};
+        std::atomic<bool> in_use{false};
+        slot* next = nullptr;
+    };
+
+    struct record {
+        std::atomic<bool> in_use{false};
+        record* next = nullptr;
+        retired_list retired;
+    };
+
+    reclamation_records<slot> slots_;
+    reclamation_records<record> records_;
+    std::mutex orphans_mutex_;
+    retired_list orphans_;
+    std::size_t batch_size_;
+
+
+    static void release_record(void* domain, void* rec) noexcept {
+        hazard_domain* self = static_cast<hazard_domain*>(domain);
+        record* r = static_cast<record*>(rec);
+        {
+            std::lock_guard lock(self->orphans_mutex_);
+            self->orphans_.splice(r->retired);
+        }
+        r->in_use.store(false, std::memory_order_release);
+    }
+
+    record* local_record() {
+        reclamation_thread_cache& cache = reclamation_thread_cache::local();
+        if (void* found = cache.find(this)) {
+            return static_cast<record*>(found);
+        }
+        record* r = records_.acquire();
+        cache.add(this, r, &release_record);
+        return r;
+    }
+
+    void scan(record* r) {
+        std::vector<const void*> hazards;
+        slots_.for_each([&hazards](const slot& s) {
+            if (const void* p = s.pointer.load(std::memory_order_seq_cst)) {
+                hazards.push_back(p);
+            }
+        });
+        std::sort(hazards.begin(), hazards.end());
+
+        retired_list candidates;
+        candidates.splice(r->retired);
+        if (orphans_mutex_.try_lock()) {
+            candidates.splice(orphans_);
+            orphans_mutex_.unlock();
+        }
+
+        retired_node* expired = nullptr;
+        for (retired_node* node = candidates.take(); node;) {
+            retired_node* next = node->next;
+            if (std::binary_search(hazards.begin(), hazards.end(), node->address())) {
+                r->retired.push(node);
+            } else {
+                node->next = expired;
+                expired = node;
+            }
+            node = next;
+        }
+        retired_list::destroy(expired);
+    }
+
+    public:
+
+    class guard {
+        slot* slot_;
+
+        public:
+
+        explicit guard(hazard_domain& domain) : slot_(domain.slots_.acquire()) {}
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+
+        ~guard() {
+            slot_->pointer.store(nullptr, std::memory_order_release);
+            slot_->in_use.store(false, std::memory_order_release);
+        }
+
+        // Публикует указатель и убеждается, что он не был заменён до публикации - после этого его можно разыменовывать
+        template <typename T>
+        T* protect(const std::atomic<T*>& source) noexcept {
+            T* ptr = source.load(std::memory_order_relaxed);
+            while (true) {
+                slot_->pointer.store(ptr, std::memory_order_seq_cst);
+                T* current = source.load(std::memory_order_seq_cst);
+                if (current == ptr) {
+                    return ptr;
+                }
+                ptr = current;
+            }
+        }
+
+        void reset() noexcept {
+            slot_->pointer.store(nullptr, std::memory_order_release);
+        }
+    };
+
+
+    explicit hazard_domain(std::size_t batch_size = 64) noexcept : batch_size_(batch_size) {}
+
+    hazard_domain(const hazard_domain&) = delete;
+    hazard_domain& operator=(const hazard_domain&) = delete;
+
+    ~hazard_domain() {
+        reclamation_thread_cache::forget(this);
+        records_.for_each([](record& r) {
+            r.retired.destroy_all();
+        });
+        orphans_.destroy_all();
+    }
+
+    static hazard_domain& global() {
+        static hazard_domain domain;
+        return domain;
+    }
+
+    [[nodiscard]] guard make_guard() {
+        return guard(*this);
+    }
+
+    template <typename T, typename D>
+    void retire(unique_ptr<T, D>&& ptr) {
+        if (!ptr) {
+            return;
+        }
+        record* r = local_record();
+        r->retired.push(new retired_unique_ptr<T, D>(std::move(ptr)));
+
+        // Порог зависит от числа слотов, чтобы каждый scan освобождал хотя бы половину списка
+        if (r->retired.size() >= std::max(batch_size_, 2 * slots_.size())) {
+            scan(r);
+        }
+    }
+
+    void collect() {
+        scan(local_record());
+    }
+};
+
+
+
+template <typename T, typename D>
+void retire(unique_ptr<T, D>&& ptr) {
+    epoch_domain::global().retire(std::move(ptr));
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+
+
+/*
+    Политики счётчика ссылок для shared_ptr и intrusive_ptr.
+
+    atomic_refcount - счётчик можно безопасно менять из разных потоков (как в std::shared_ptr), но каждое копирование указателя
+    стоит атомарной операции с lock-префиксом и гоняет кэш-линию между ядрами.
+
+    local_refcount - обычный long без синхронизации. Подходит для объектов, которые никогда не покидают свой поток (например,
+    внутри однопоточного шарда): копирование становится обычным инкрементом. Передавать такие указатели между потоками нельзя.
+
+    Интерфейс у обеих политик одинаковый:
+    - increment / add - увеличить счётчик;
+    - decrement / sub - уменьшить и вернуть новое значение (на нуле вызывающий освобождает ресурс);
+    - increment_if_nonzero - увеличить, только если объект ещё жив (нужно для weak_ptr::lock);
+    - load - текущее значение.
+*/
+
+
+struct atomic_refcount {
+    using counter_type = std::atomic<long>;
+
+    static void increment(counter_type& counter) noexcept {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void add(counter_type& counter, long n) noexcept {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // acq_rel: все изменения объекта из других потоков должны быть видны тому, кто его удаляет
+    static long decrement(counter_type& counter) noexcept {
+        return counter.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    static long sub(counter_type& counter, long n) noexcept {
+        return counter.fetch_sub(n, std::memory_order_acq_rel) - n;
+    }
+
+    static bool increment_if_nonzero(counter_type& counter) noexcept {
+        long value = counter.load(std::memory_order_relaxed);
+        while (value != 0) {
+            if (counter.compare_exchange_weak(value, value + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static long load(const counter_type& counter) noexcept {
+        return counter.load(std::memory_order_acquire);
+    }
+};
+
+
+struct local_refcount {
+    using counter_type = long;
+
+    static void increment(counter_type& counter) noexcept {
+        ++counter;
+    }
+
+    static void add(counter_type& counter, long n) noexcept {
+        counter += n;
+    }
+
+    static long decrement(counter_type& counter) noexcept {
+        return --counter;
+    }
+
+    static long sub(counter_type& counter, long n) noexcept {
+        return counter -= n;
+    }
+
+    static bool increment_if_nonzero(counter_type& counter) noexcept {
+        if (counter == 0) {
+            return false;
+        }
+        ++counter;
+        return true;
+    }
+
+    static long load(const counter_type& counter) noexcept {
+        return counter;
+    }
+};
@@ -0,0 +1,738 @@
+#pragma once
+#include <iostream>
+#include <type_traits>
+#include <memory>
+#include <compare>
+#include <utility>
+#include "refcount_policy.h"
+#include "unique_ptr.h"
+
+
+/*
+    shared_ptr и weak_ptr.
+
+    shared_ptr хранит два указателя: на объект (ptr_) и на блок управления (control block), в котором лежат счётчики сильных и
+    слабых ссылок, а также всё, что нужно для удаления объекта (deleter, аллокатор). Указатели разделены, потому что благодаря
+    aliasing-конструктору shared_ptr может указывать на подобъект (например, на поле структуры), продлевая жизнь всей структуры.
+
+    Счётчик слабых ссылок хранит "+1" пока жив хотя бы один shared_ptr - тогда блок управления освобождается ровно один раз:
+    когда последний shared_ptr уничтожает объект, он отдаёт эту единицу, и блок удаляет тот, кто обнулил счётчик слабых.
+
+    make_shared / allocate_shared размещают объект прямо внутри блока управления - одно выделение памяти вместо двух, а
+    счётчики и объект оказываются рядом в памяти.
+
+    Второй шаблонный параметр - политика счётчика (refcount_policy.h): atomic_refcount по умолчанию и local_refcount для
+    объектов, которые не покидают свой поток.
+*/
+
+
+template <typename T, typename Policy = atomic_refcount>
+class shared_ptr;
+
+template <typename T, typename Policy = atomic_refcount>
+class weak_ptr;
+
+template <typename T, typename Policy = atomic_refcount>
+class enable_shared_from_this;
+
+
+class bad_weak_ptr : public std::exception {
+    public:
+    const char* what() const noexcept override {
+        return "bad_weak_ptr";
+    }
+};
+
+
+
+template <typename Policy>
+class control_block {
+    typename Policy::counter_type shared_{1};
+    typename Policy::counter_type weak_{1};
+
+    public:
+
+    control_block() noexcept = default;
+    control_block(const control_block&) = delete;
+    control_block& operator=(const control_block&) = delete;
+
+    // Уничтожает управляемый объект
+    virtual void dispose() noexcept = 0;
+
+    // Уничтожает и освобождает сам блок управления
+    virtual void destroy() noexcept = 0;
+
+    void add_shared(long n = 1) noexcept {
+        Policy::add(shared_, n);
+    }
+
+    bool try_add_shared() noexcept {
+        return Policy::increment_if_nonzero(shared_);
+    }
+
+    void release_shared(long n = 1) noexcept {
+        if (Policy::sub(shared_, n) == 0) {
+            dispose();
+            release_weak();
+        }
+    }
+
+    void add_weak() noexcept {
+        Policy::increment(weak_);
+    }
+
+    void release_weak() noexcept {
+        if (Policy::decrement(weak_) == 0) {
+            destroy();
+        }
+    }
+
+    long use_count() const noexcept {
+        return Policy::load(shared_);
+    }
+
+    protected:
+
+    virtual ~control_block() = default;
+};
+
+
+// Блок для shared_ptr(p, d, a): объект выделен отдельно, блок хранит указатель, deleter и аллокатор
+template <typename Y, typename D, typename A, typename Policy>
+class pointer_control_block final : public control_block<Policy> {
+    using allocator_type = typename std::allocator_traits<A>::template rebind_alloc<pointer_control_block>;
+    using traits = std::allocator_traits<allocator_type>;
+
+    Y* ptr_;
+    [[no_unique_address]] D deleter_;
+    [[no_unique_address]] allocator_type alloc_;
+
+    public:
+
+    pointer_control_block(Y* ptr, D deleter, const A& alloc) noexcept : ptr_(ptr), deleter_(std::move(deleter)), alloc_(alloc) {}
+
+    void dispose() noexcept override {
+        deleter_(ptr_);
+    }
+
+    void destroy() noexcept override {
+        allocator_type alloc(std::move(alloc_));
+        this->~pointer_control_block();
+        traits::deallocate(alloc, std::pointer_traits<typename traits::pointer>::pointer_to(*this), 1);
+    }
+};
+
+
+// Блок для make_shared / allocate_shared: объект живёт внутри блока
+template <typename T, typename A, typename Policy>
+class inplace_control_block final : public control_block<Policy> {
+    using allocator_type = typename std::allocator_traits<A>::template rebind_alloc<inplace_control_block>;
+    using traits = std::allocator_traits<allocator_type>;
+    using object_allocator_type = typename std::allocator_traits<A>::template rebind_alloc<std::remove_cv_t<T>>;
+
+    [[no_unique_address]] allocator_type alloc_;
+    alignas(T) unsigned char storage_[sizeof(T)];
+
+    public:
+
+    template <typename ... Args>
+    inplace_control_block(const A& alloc, Args&& ... args) : alloc_(alloc) {
+        object_allocator_type object_alloc(alloc_);
+        std::allocator_traits<object_allocator_type>::construct(object_alloc, get(), std::forward<Args>(args) ...);
+    }
+
+    std::remove_cv_t<T>* get() noexcept {
+        return reinterpret_cast<std::remove_cv_t<T>*>(storage_);
+    }
+
+    void dispose() noexcept override {
+        object_allocator_type object_alloc(alloc_);
+        std::allocator_traits<object_allocator_type>::destroy(object_alloc, get());
+    }
+
+    void destroy() noexcept override {
+        allocator_type alloc(std::move(alloc_));
+        this->~inplace_control_block();
+        traits::deallocate(alloc, std::pointer_traits<typename traits::pointer>::pointer_to(*this), 1);
+    }
+
+    template <typename ... Args>
+    static inplace_control_block* create(const A& alloc, Args&& ... args) {
+        allocator_type block_alloc(alloc);
+        typename traits::pointer memory = traits::allocate(block_alloc, 1);
+        try {
+            return ::new (static_cast<void*>(std::to_address(memory))) inplace_control_block(alloc, std::forward<Args>(args) ...);
+        } catch (...) {
+            traits::deallocate(block_alloc, memory, 1);
+            throw;
+        }
+    }
+};
+
+
+// Даёт make_shared, atomic_shared_ptr и т.п. доступ к внутреннему представлению shared_ptr/weak_ptr
+struct shared_ptr_access {
+    template <typename T, typename Policy>
+    static shared_ptr<T, Policy> adopt(T* ptr, control_block<Policy>* cb) noexcept {
+        shared_ptr<T, Policy> result;
+        result.ptr_ = ptr;
+        result.cb_ = cb;
+        result.enable_weak_this(ptr);
+        return result;
+    }
+
+    template <typename T, typename Policy>
+    static control_block<Policy>* get_control_block(const shared_ptr<T, Policy>& p) noexcept {
+        return p.cb_;
+    }
+
+    template <typename T, typename Policy>
+    static control_block<Policy>* release(shared_ptr<T, Policy>& p) noexcept {
+        p.ptr_ = nullptr;
+        return std::exchange(p.cb_, nullptr);
+    }
+};
+
+
+
+template <typename T, typename Policy>
+class shared_ptr {
+    T* ptr_;
+    control_block<Policy>* cb_;
+
+    template <typename U, typename P>
+    friend class shared_ptr;
+
+    template <typename U, typename P>
+    friend class weak_ptr;
+
+    friend struct shared_ptr_access;
+
+    // Если выделить блок не удалось, объект, переданный сырым указателем, удаляется (как в std), иначе течёт память
+    template <typename Y, typename D, typename A>
+    void create_control_block(Y* p, D&& d, const A& alloc, bool dispose_on_failure = true) {
+        using block_type = pointer_control_block<Y, std::decay_t<D>, A, Policy>;
+        using block_allocator = typename std::allocator_traits<A>::template rebind_alloc<block_type>;
+        using block_traits = std::allocator_traits<block_allocator>;
+
+        block_allocator block_alloc(alloc);
+        try {
+            typename block_traits::pointer memory = block_traits::allocate(block_alloc, 1);
+            cb_ = ::new (static_cast<void*>(std::to_address(memory))) block_type(p, std::forward<D>(d), alloc);
+        } catch (...) {
+            if (dispose_on_failure) {
+                d(p);
+            }
+            throw;
+        }
+    }
+
+    // Если объект унаследован от enable_shared_from_this, запоминаем в нём weak_ptr на самого себя
+    template <typename Y>
+    void enable_weak_this(Y* p) noexcept {
+        if constexpr (requires { typename Y::enable_shared_from_this_type; }) {
+            using base_type = typename Y::enable_shared_from_this_type;
+            if constexpr (std::is_same_v<typename base_type::policy_type, Policy> && std::is_convertible_v<Y*, const base_type*>) {
+                if (p != nullptr) {
+                    const base_type* base = p;
+                    if (base->weak_this_.expired()) {
+                        base->weak_this_ = shared_ptr<std::remove_cv_t<Y>, Policy>(*this, const_cast<std::remove_cv_t<Y>*>(p));
+                    }
+                }
+            }
+        }
+    }
+
+    public:
+
+    using element_type = std::remove_extent_t<T>;
+    using weak_type = weak_ptr<T, Policy>;
+    using policy_type = Policy;
+
+
+
+    // Constructors
+
+    constexpr shared_ptr() noexcept : ptr_(nullptr), cb_(nullptr) {}
+
+    constexpr shared_ptr(std::nullptr_t) noexcept : ptr_(nullptr), cb_(nullptr) {}
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    explicit shared_ptr(Y* p) : ptr_(p), cb_(nullptr) {
+        create_control_block(p, std::default_delete<Y>(), std::allocator<Y>());
+        enable_weak_this(p);
+    }
+
+    template <typename Y, typename D>
+    requires std::convertible_to<Y*, T*> && std::invocable<D&, Y*>
+    shared_ptr(Y* p, D d) : ptr_(p), cb_(nullptr) {
+        create_control_block(p, std::move(d), std::allocator<Y>());
+        enable_weak_this(p);
+    }
+
+    template <typename Y, typename D, typename A>
+    requires std::convertible_to<Y*, T*> && std::invocable<D&, Y*>
+    shared_ptr(Y* p, D d, A alloc) : ptr_(p), cb_(nullptr) {
+        create_control_block(p, std::move(d), alloc);
+        enable_weak_this(p);
+    }
+
+    template <typename D>
+    requires std::invocable<D&, std::nullptr_t>
+    shared_ptr(std::nullptr_t, D d) : ptr_(nullptr), cb_(nullptr) {
+        create_control_block(static_cast<T*>(nullptr), std::move(d), std::allocator<T>());
+    }
+
+    // aliasing-конструктор: разделяет владение с r, но указывает на p (обычно на подобъект *r)
+    template <typename Y>
+    shared_ptr(const shared_ptr<Y, Policy>& r, element_type* p) noexcept : ptr_(p), cb_(r.cb_) {
+        if (cb_) {
+            cb_->add_shared();
+        }
+    }
+
+    template <typename Y>
+    shared_ptr(shared_ptr<Y, Policy>&& r, element_type* p) noexcept : ptr_(p), cb_(r.cb_) {
+        r.ptr_ = nullptr;
+        r.cb_ = nullptr;
+    }
+
+    shared_ptr(const shared_ptr& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        if (cb_) {
+            cb_->add_shared();
+        }
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr(const shared_ptr<Y, Policy>& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        if (cb_) {
+            cb_->add_shared();
+        }
+    }
+
+    shared_ptr(shared_ptr&& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        other.ptr_ = nullptr;
+        other.cb_ = nullptr;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr(shared_ptr<Y, Policy>&& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        other.ptr_ = nullptr;
+        other.cb_ = nullptr;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    explicit shared_ptr(const weak_ptr<Y, Policy>& r) : ptr_(nullptr), cb_(nullptr) {
+        if (r.cb_ == nullptr || !r.cb_->try_add_shared()) {
+            throw bad_weak_ptr();
+        }
+        ptr_ = r.ptr_;
+        cb_ = r.cb_;
+    }
+
+    template <typename Y, typename D>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr(unique_ptr<Y, D>&& r) : ptr_(r.get()), cb_(nullptr) {
+        if (ptr_) {
+            Y* p = r.get();
+            create_control_block(p, std::move(r.get_deleter()), std::allocator<Y>(), false);
+            r.release();
+            enable_weak_this(p);
+        }
+    }
+
+
+
+    // Destructor
+
+    ~shared_ptr() {
+        if (cb_) {
+            cb_->release_shared();
+        }
+    }
+
+
+
+    // Assignment
+
+    shared_ptr& operator=(const shared_ptr& other) noexcept {
+        shared_ptr(other).swap(*this);
+        return *this;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr& operator=(const shared_ptr<Y, Policy>& other) noexcept {
+        shared_ptr(other).swap(*this);
+        return *this;
+    }
+
+    shared_ptr& operator=(shared_ptr&& other) noexcept {
+        shared_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr& operator=(shared_ptr<Y, Policy>&& other) noexcept {
+        shared_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    template <typename Y, typename D>
+    requires std::convertible_to<Y*, T*>
+    shared_ptr& operator=(unique_ptr<Y, D>&& other) {
+        shared_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+
+
+    // Modifiers
+
+    void reset() noexcept {
+        shared_ptr().swap(*this);
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    void reset(Y* p) {
+        shared_ptr(p).swap(*this);
+    }
+
+    template <typename Y, typename D>
+    requires std::convertible_to<Y*, T*>
+    void reset(Y* p, D d) {
+        shared_ptr(p, std::move(d)).swap(*this);
+    }
+
+    template <typename Y, typename D, typename A>
+    requires std::convertible_to<Y*, T*>
+    void reset(Y* p, D d, A alloc) {
+        shared_ptr(p, std::move(d), std::move(alloc)).swap(*this);
+    }
+
+    void swap(shared_ptr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        std::swap(cb_, other.cb_);
+    }
+
+
+
+    // Observers
+
+    element_type* get() const noexcept {
+        return ptr_;
+    }
+
+    template <typename U = T>
+    requires (!std::is_void_v<U>)
+    U& operator*() const noexcept {
+        return *ptr_;
+    }
+
+    T* operator->() const noexcept {
+        return ptr_;
+    }
+
+    long use_count() const noexcept {
+        return cb_ ? cb_->use_count() : 0;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    template <typename Y>
+    bool owner_before(const shared_ptr<Y, Policy>& other) const noexcept {
+        return std::less<>()(cb_, other.cb_);
+    }
+
+    template <typename Y>
+    bool owner_before(const weak_ptr<Y, Policy>& other) const noexcept {
+        return std::less<>()(cb_, other.cb_);
+    }
+};
+
+
+
+template <typename T, typename Policy>
+class weak_ptr {
+    T* ptr_;
+    control_block<Policy>* cb_;
+
+    template <typename U, typename P>
+    friend class shared_ptr;
+
+    template <typename U, typename P>
+    friend class weak_ptr;
+
+    public:
+
+    using element_type = std::remove_extent_t<T>;
+    using policy_type = Policy;
+
+
+
+    // Constructors
+
+    constexpr weak_ptr() noexcept : ptr_(nullptr), cb_(nullptr) {}
+
+    weak_ptr(const weak_ptr& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        if (cb_) {
+            cb_->add_weak();
+        }
+    }
+
+    // Объект мог уже умереть, а приведение к виртуальной базе читает его память, поэтому указатель берём через lock()
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr(const weak_ptr<Y, Policy>& other) noexcept : ptr_(other.lock().get()), cb_(other.cb_) {
+        if (cb_) {
+            cb_->add_weak();
+        }
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr(const shared_ptr<Y, Policy>& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        if (cb_) {
+            cb_->add_weak();
+        }
+    }
+
+    weak_ptr(weak_ptr&& other) noexcept : ptr_(other.ptr_), cb_(other.cb_) {
+        other.ptr_ = nullptr;
+        other.cb_ = nullptr;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr(weak_ptr<Y, Policy>&& other) noexcept : ptr_(other.lock().get()), cb_(other.cb_) {
+        other.ptr_ = nullptr;
+        other.cb_ = nullptr;
+    }
+
+
+
+    // Destructor
+
+    ~weak_ptr() {
+        if (cb_) {
+            cb_->release_weak();
+        }
+    }
+
+
+
+    // Assignment
+
+    weak_ptr& operator=(const weak_ptr& other) noexcept {
+        weak_ptr(other).swap(*this);
+        return *this;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr& operator=(const weak_ptr<Y, Policy>& other) noexcept {
+        weak_ptr(other).swap(*this);
+        return *this;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr& operator=(const shared_ptr<Y, Policy>& other) noexcept {
+        weak_ptr(other).swap(*this);
+        return *this;
+    }
+
+    weak_ptr& operator=(weak_ptr&& other) noexcept {
+        weak_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    template <typename Y>
+    requires std::convertible_to<Y*, T*>
+    weak_ptr& operator=(weak_ptr<Y, Policy>&& other) noexcept {
+        weak_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+
+
+    // Modifiers
+
+    void reset() noexcept {
+        weak_ptr().swap(*this);
+    }
+
+    void swap(weak_ptr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        std::swap(cb_, other.cb_);
+    }
+
+
+
+    // Observers
+
+    long use_count() const noexcept {
+        return cb_ ? cb_->use_count() : 0;
+    }
+
+    bool expired() const noexcept {
+        return use_count() == 0;
+    }
+
+    shared_ptr<T, Policy> lock() const noexcept {
+        shared_ptr<T, Policy> result;
+        if (cb_ && cb_->try_add_shared()) {
+            result.ptr_ = ptr_;
+            result.cb_ = cb_;
+        }
+        return result;
+    }
+
+    template <typename Y>
+    bool owner_before(const shared_ptr<Y, Policy>& other) const noexcept {
+        return std::less<>()(cb_, other.cb_);
+    }
+
+    template <typename Y>
+    bool owner_before(const weak_ptr<Y, Policy>& other) const noexcept {
+        return std::less<>()(cb_, other.cb_);
+    }
+};
+
+
+
+template <typename T, typename Policy>
+class enable_shared_from_this {
+    mutable weak_ptr<T, Policy> weak_this_;
+
+    template <typename U, typename P>
+    friend class shared_ptr;
+
+    protected:
+
+    constexpr enable_shared_from_this() noexcept = default;
+
+    // Копия объекта - это другой объект, у него свой владелец, поэтому weak_this_ не копируется
+    enable_shared_from_this(const enable_shared_from_this&) noexcept {}
+
+    enable_shared_from_this& operator=(const enable_shared_from_this&) noexcept {
+        return *this;
+    }
+
+    ~enable_shared_from_this() = default;
+
+    public:
+
+    using enable_shared_from_this_type = enable_shared_from_this;
+    using policy_type = Policy;
+
+    shared_ptr<T, Policy> shared_from_this() {
+        return shared_ptr<T, Policy>(weak_this_);
+    }
+
+    shared_ptr<const T, Policy> shared_from_this() const {
+        return shared_ptr<const T, Policy>(weak_this_);
+    }
+
+    weak_ptr<T, Policy> weak_from_this() noexcept {
+        return weak_this_;
+    }
+
+    weak_ptr<const T, Policy> weak_from_this() const noexcept {
+        return weak_this_;
+    }
+};
+
+
+template <typename T>
+using local_shared_ptr = shared_ptr<T, local_refcount>;
+
+template <typename T>
+using local_weak_ptr = weak_ptr<T, local_refcount>;
+
+
+
+// Non-member functions
+
+template <typename T, typename Policy = atomic_refcount, typename Alloc, typename... Args>
+requires (!std::is_array_v<T>)
+shared_ptr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args) {
+    using block_type = inplace_control_block<T, Alloc, Policy>;
+    block_type* block = block_type::create(alloc, std::forward<Args>(args)...);
+    return shared_ptr_access::adopt<T, Policy>(block->get(), block);
+}
+
+template <typename T, typename Policy = atomic_refcount, typename... Args>
+requires (!std::is_array_v<T>)
+shared_ptr<T, Policy> make_shared(Args&&... args) {
+    return allocate_shared<T, Policy>(std::allocator<std::remove_cv_t<T>>(), std::forward<Args>(args)...);
+}
+
+
+template <typename T, typename U, typename Policy>
+shared_ptr<T, Policy> static_pointer_cast(const shared_ptr<U, Policy>& r) noexcept {
+    return shared_ptr<T, Policy>(r, static_cast<typename shared_ptr<T, Policy>::element_type*>(r.get()));
+}
+
+template <typename T, typename U, typename Policy>
+shared_ptr<T, Policy> dynamic_pointer_cast(const shared_ptr<U, Policy>& r) noexcept {
+    if (auto* p = dynamic_cast<typename shared_ptr<T, Policy>::element_type*>(r.get())) {
+        return shared_ptr<T, Policy>(r, p);
+    }
+    return shared_ptr<T, Policy>();
+}
+
+template <typename T, typename U, typename Policy>
+shared_ptr<T, Policy> const_pointer_cast(const shared_ptr<U, Policy>& r) noexcept {
+    return shared_ptr<T, Policy>(r, const_cast<typename shared_ptr<T, Policy>::element_type*>(r.get()));
+}
+
+template <typename T, typename U, typename Policy>
+shared_ptr<T, Policy> reinterpret_pointer_cast(const shared_ptr<U, Policy>& r) noexcept {
+    return shared_ptr<T, Policy>(r, reinterpret_cast<typename shared_ptr<T, Policy>::element_type*>(r.get()));
+}
+
+
+template <typename T, typename U, typename Policy>
+bool operator==(const shared_ptr<T, Policy>& x, const shared_ptr<U, Policy>& y) noexcept {
+    return x.get() == y.get();
+}
+
+template <typename T, typename Policy>
+bool operator==(const shared_ptr<T, Policy>& x, std::nullptr_t) noexcept {
+    return x.get() == nullptr;
+}
+
+template <typename T, typename U, typename Policy>
+std::strong_ordering operator<=>(const shared_ptr<T, Policy>& x, const shared_ptr<U, Policy>& y) noexcept {
+    return std::compare_three_way()(x.get(), y.get());
+}
+
+template <typename T, typename Policy>
+std::strong_ordering operator<=>(const shared_ptr<T, Policy>& x, std::nullptr_t) noexcept {
+    return std::compare_three_way()(x.get(), static_cast<typename shared_ptr<T, Policy>::element_type*>(nullptr));
+}
+
+
+template <typename T, typename Policy>
+void swap(shared_ptr<T, Policy>& lhs, shared_ptr<T, Policy>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename T, typename Policy>
+void swap(weak_ptr<T, Policy>& lhs, weak_ptr<T, Policy>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template <typename CharT, typename Traits, typename T, typename Policy>
+std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const shared_ptr<T, Policy>& p) {
+    return os << p.get();
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <iostream>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "unique_ptr.h"
+
+
+/*
+    tagged_unique_ptr<T, Bits, Deleter> - unique_ptr, который в том же машинном слове хранит Bits-битную метку (например,
+    флаги ребёнка в узле trie). Отдельный байт под флаги рядом с указателем из-за выравнивания стоит целых 8 байт узла.
+
+    Куда кладётся метка:
+    - если Bits не больше числа нулевых младших битов адреса (log2(alignof(T))), метка хранится в них;
+    - иначе - в старших 16 битах. На x86-64 и aarch64 адреса пространства пользователя занимают младшие 48 бит, так что
+      старшие биты указателя из new всегда нулевые. На других платформах такая конфигурация не компилируется.
+    Перед разыменованием метка вырезается маской, при перемещении она переезжает вместе с указателем.
+
+    Это по-прежнему один uintptr_t (плюс пустой deleter), без нетривиального состояния: побайтовое перемещение объекта
+    корректно (trivially relocatable), хотя в C++20 это и нельзя выразить в типе.
+
+    С обычным unique_ptr тип связан в обе стороны: можно принять владение из unique_ptr<T, Deleter> и вернуть его через
+    to_unique(); метка при этом остаётся в tagged_unique_ptr.
+
+    Требования к выравниванию вычисляются в функциях, а не в теле класса, поэтому T может быть неполным в момент объявления
+    поля (узел, хранящий tagged_unique_ptr на такие же узлы).
+*/
+
+
+template <typename T, unsigned Bits, typename Deleter = std::default_delete<T>>
+class tagged_unique_ptr {
+    static_assert(Bits > 0 && Bits <= 16, "tagged_unique_ptr supports tags of 1..16 bits");
+    static_assert(sizeof(std::uintptr_t) == sizeof(T*));
+
+    std::uintptr_t bits_;
+    [[no_unique_address]] Deleter deleter_;
+
+
+    static constexpr bool tag_in_low_bits() noexcept {
+        return Bits <= static_cast<unsigned>(std::countr_zero(alignof(T)));
+    }
+
+    static constexpr unsigned tag_shift() noexcept {
+        if constexpr (tag_in_low_bits()) {
+            return 0;
+        } else {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)
+            return 48;
+#else
+            static_assert(tag_in_low_bits(), "not enough alignment bits for the tag and no spare high pointer bits on this platform");
+            return 0;
+#endif
+        }
+    }
+
+    static constexpr std::uintptr_t tag_mask() noexcept {
+        return ((std::uintptr_t(1) << Bits) - 1) << tag_shift();
+    }
+
+    static std::uintptr_t pack(T* p, std::uintptr_t tag) noexcept {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        assert((address & tag_mask()) == 0 && "pointer uses the bits reserved for the tag");
+        assert(tag <= max_tag && "tag does not fit into Bits");
+        return address | (tag << tag_shift());
+    }
+
+    public:
+
+    using pointer = T*;
+    using element_type = T;
+    using deleter_type = Deleter;
+    using tag_type = std::uintptr_t;
+
+    static constexpr tag_type max_tag = (tag_type(1) << Bits) - 1;
+
+
+
+    // Constructors
+
+    constexpr tagged_unique_ptr() noexcept : bits_(0) {}
+
+    constexpr tagged_unique_ptr(std::nullptr_t) noexcept : bits_(0) {}
+
+    explicit tagged_unique_ptr(pointer p, tag_type tag = 0) noexcept : bits_(pack(p, tag)) {}
+
+    tagged_unique_ptr(pointer p, tag_type tag, const Deleter& d) noexcept(std::is_nothrow_copy_constructible_v<Deleter>)
+    : bits_(pack(p, tag)), deleter_(d) {}
+
+    explicit tagged_unique_ptr(unique_ptr<T, Deleter>&& p, tag_type tag = 0) noexcept(std::is_nothrow_move_constructible_v<Deleter>)
+    : bits_(pack(p.get(), tag)), deleter_(std::move(p.get_deleter())) {
+        p.release();
+    }
+
+    tagged_unique_ptr(tagged_unique_ptr&& other) noexcept(std::is_nothrow_move_constructible_v<Deleter>)
+    : bits_(other.bits_), deleter_(std::move(other.deleter_)) {
+        other.bits_ = 0;
+    }
+
+    tagged_unique_ptr(const tagged_unique_ptr&) = delete;
+
+
+
+    // Destructor
+
+    ~tagged_unique_ptr() {
+        if (pointer p = get()) {
+            deleter_(p);
+        }
+    }
+
+
+
+    // Assignment
+
+    tagged_unique_ptr& operator=(tagged_unique_ptr&& other) noexcept(std::is_nothrow_move_assignable_v<Deleter>) {
+        if (this != std::addressof(other)) {
+            tag_type tag = other.tag();
+            reset(other.release(), tag);
+            other.set_tag(0);
+            deleter_ = std::move(other.deleter_);
+        }
+        return *this;
+    }
+
+    tagged_unique_ptr& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    tagged_unique_ptr& operator=(const tagged_unique_ptr&) = delete;
+
+
+
+    // Modifiers
+
+    // Заменяет указатель, сохраняя текущую метку
+    void reset(pointer p = pointer()) noexcept {
+        reset(p, tag());
+    }
+
+    void reset(pointer p, tag_type tag) noexcept {
+        pointer old = get();
+        bits_ = pack(p, tag);
+        if (old) {
+            deleter_(old);
+        }
+    }
+
+    // Отдаёт указатель без метки; метка остаётся
+    pointer release() noexcept {
+        pointer p = get();
+        bits_ &= tag_mask();
+        return p;
+    }
+
+    unique_ptr<T, Deleter> to_unique() noexcept {
+        pointer p = release();
+        return unique_ptr<T, Deleter>(p, deleter_);
+    }
+
+    void set_tag(tag_type tag) noexcept {
+        assert(tag <= max_tag && "tag does not fit into Bits");
+        bits_ = (bits_ & ~tag_mask()) | (tag << tag_shift());
+    }
+
+    void swap(tagged_unique_ptr& other) noexcept(std::is_nothrow_swappable_v<Deleter>) {
+        std::swap(bits_, other.bits_);
+        std::swap(deleter_, other.deleter_);
+    }
+
+
+
+    // Observers
+
+    pointer get() const noexcept {
+        return reinterpret_cast<pointer>(bits_ & ~tag_mask());
+    }
+
+    tag_type tag() const noexcept {
+        return (bits_ & tag_mask()) >> tag_shift();
+    }
+
+    Deleter& get_deleter() noexcept {
+        return deleter_;
+    }
+
+    const Deleter& get_deleter() const noexcept {
+        return deleter_;
+    }
+
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+
+    T& operator*() const noexcept {
+        return *get();
+    }
+
+    pointer operator->() const noexcept {
+        return get();
+    }
+};
+
+
+
+// Non-member functions
+
+// Сравниваются только указатели, метка в равенстве не участвует
+template <typename T, unsigned B, typename D>
+bool operator==(const tagged_unique_ptr<T, B, D>& x, const tagged_unique_ptr<T, B, D>& y) noexcept {
+    return x.get() == y.get();
+}
+
+template <typename T, unsigned B, typename D>
+bool operator==(const tagged_unique_ptr<T, B, D>& x, std::nullptr_t) noexcept {
+    return x.get() == nullptr;
+}
+
+template <typename T, unsigned B, typename D>
+void swap(tagged_unique_ptr<T, B, D>& lhs, tagged_unique_ptr<T, B, D>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+template <typename CharT, typename Traits, typename T, unsigned B, typename D>
+std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const tagged_unique_ptr<T, B, D>& p) {
+    return os << p.get() << '#' << p.tag();
+}
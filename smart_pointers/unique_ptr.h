@@ -134,7 +134,11 @@ public:
     // Modifiers
 
     constexpr void reset(pointer new_ptr = pointer()) noexcept {
+        pointer old_ptr = ptr;
         ptr = new_ptr;
+        if (old_ptr) {
+            deleter(old_ptr);
+        }
     }
 
     void swap(unique_ptr& other) 
@@ -197,17 +201,18 @@ public:
 
     constexpr unique_ptr(std::nullptr_t) noexcept : ptr(nullptr) {}
 
+    // Как и в std, из указателя на массив производного класса конструироваться нельзя: U(*)[] должен приводиться к T(*)[]
     template <typename U>
-    requires std::is_array_v<U> && std::convertible_to<typename unique_ptr<U, Deleter>::pointer, pointer>
-    explicit constexpr unique_ptr(U* p) noexcept(std::is_nothrow_default_constructible_v<deleter_type>) : ptr(p) {}
+    requires std::same_as<U, pointer> || (std::is_pointer_v<U> && std::convertible_to<std::remove_pointer_t<U>(*)[], T(*)[]>)
+    explicit constexpr unique_ptr(U p) noexcept(std::is_nothrow_default_constructible_v<deleter_type>) : ptr(p) {}
 
     template <typename U>
-    requires std::is_array_v<U> && std::convertible_to<typename unique_ptr<U, Deleter>::pointer, pointer>
-    explicit constexpr unique_ptr(U* p, const deleter_type& del) noexcept(std::is_nothrow_copy_constructible_v<deleter_type>) : ptr(p), deleter(del) {}
+    requires std::same_as<U, pointer> || (std::is_pointer_v<U> && std::convertible_to<std::remove_pointer_t<U>(*)[], T(*)[]>)
+    explicit constexpr unique_ptr(U p, const deleter_type& del) noexcept(std::is_nothrow_copy_constructible_v<deleter_type>) : ptr(p), deleter(del) {}
 
     template <typename U>
-    requires std::is_array_v<U> && std::convertible_to<typename unique_ptr<U, Deleter>::pointer, pointer>
-    constexpr unique_ptr(U* p, deleter_type&& d) noexcept(std::is_nothrow_move_constructible_v<deleter_type>) : ptr(p), deleter(std::move(d)) {}
+    requires std::same_as<U, pointer> || (std::is_pointer_v<U> && std::convertible_to<std::remove_pointer_t<U>(*)[], T(*)[]>)
+    constexpr unique_ptr(U p, deleter_type&& d) noexcept(std::is_nothrow_move_constructible_v<deleter_type>) : ptr(p), deleter(std::move(d)) {}
 
     constexpr unique_ptr(std::nullptr_t, const deleter_type& del) noexcept(std::is_nothrow_copy_constructible_v<deleter_type>) : ptr(nullptr), deleter(del) {}
 
@@ -231,8 +236,10 @@ public:
     // Destructor
 
     constexpr ~unique_ptr() {
-        deleter(ptr);
-    }   
+        if (ptr) {
+            deleter(ptr);
+        }
+    }
 
 
 
@@ -275,8 +282,8 @@ public:
     }
 
     template <typename U>
-    requires std::is_array_v<U> && std::convertible_to<U*, pointer>
-    void reset(U* p = nullptr) noexcept(std::is_nothrow_invocable_v<deleter_type&, pointer>) {
+    requires std::same_as<U, pointer> || (std::is_pointer_v<U> && std::convertible_to<std::remove_pointer_t<U>(*)[], T(*)[]>)
+    void reset(U p) noexcept(std::is_nothrow_invocable_v<deleter_type&, pointer>) {
         pointer old_ptr = ptr;
         ptr = p;
         if (old_ptr) {
@@ -284,6 +291,10 @@ public:
         }
     }
 
+    void reset(std::nullptr_t = nullptr) noexcept(std::is_nothrow_invocable_v<deleter_type&, pointer>) {
+        reset(pointer());
+    }
+
     void swap(unique_ptr& other) 
     noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Deleter>, std::is_nothrow_move_assignable<Deleter>>) {
         std::swap(ptr, other.ptr);
@@ -436,6 +447,128 @@ std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>&
 
 
 template <typename T, typename... Args>
+requires (!std::is_array_v<T>)
 constexpr unique_ptr<T> make_unique( Args&&... args) {
-    return unique_ptr(new T(std::forward<Args>(args)...));
-}
\ No newline at end of file
+    return unique_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+// new T[n]() - элементы value-инициализируются (для тривиальных типов это зануление)
+template <typename T>
+requires std::is_unbounded_array_v<T>
+constexpr unique_ptr<T> make_unique(std::size_t n) {
+    return unique_ptr<T>(new std::remove_extent_t<T>[n]());
+}
+
+template <typename T, typename... Args>
+requires std::is_bounded_array_v<T>
+void make_unique(Args&&...) = delete;
+
+
+/*
+    make_unique_for_overwrite использует default-инициализацию: new T вместо new T(). Для тривиальных типов память не зануляется,
+    что полезно для больших буферов, которые всё равно будут целиком перезаписаны.
+*/
+template <typename T>
+requires (!std::is_array_v<T>)
+constexpr unique_ptr<T> make_unique_for_overwrite() {
+    return unique_ptr<T>(new T);
+}
+
+template <typename T>
+requires std::is_unbounded_array_v<T>
+constexpr unique_ptr<T> make_unique_for_overwrite(std::size_t n) {
+    return unique_ptr<T>(new std::remove_extent_t<T>[n]);
+}
+
+template <typename T, typename... Args>
+requires std::is_bounded_array_v<T>
+void make_unique_for_overwrite(Args&&...) = delete;
+
+
+
+/*
+    allocator_delete - deleter, который уничтожает и освобождает объект через аллокатор, из которого он был получен. Аллокатор
+    хранится внутри deleter'а (для stateless аллокаторов благодаря [[no_unique_address]] размер unique_ptr не меняется).
+    Версия для массивов дополнительно хранит количество элементов, поскольку deallocate требует размер.
+*/
+template <typename T, typename Alloc>
+struct allocator_delete {
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using traits = std::allocator_traits<allocator_type>;
+    using pointer = T*;
+
+    [[no_unique_address]] allocator_type alloc;
+
+    template <typename A>
+    explicit allocator_delete(const A& a) noexcept : alloc(a) {}
+
+    void operator()(pointer ptr) noexcept {
+        traits::destroy(alloc, ptr);
+        traits::deallocate(alloc, std::pointer_traits<typename traits::pointer>::pointer_to(*ptr), 1);
+    }
+};
+
+template <typename T, typename Alloc>
+struct allocator_delete<T[], Alloc> {
+    using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using traits = std::allocator_traits<allocator_type>;
+    using pointer = T*;
+
+    [[no_unique_address]] allocator_type alloc;
+    std::size_t count;
+
+    template <typename A>
+    allocator_delete(const A& a, std::size_t n) noexcept : alloc(a), count(n) {}
+
+    void operator()(pointer ptr) noexcept {
+        for (std::size_t i = count; i > 0; --i) {
+            traits::destroy(alloc, ptr + i - 1);
+        }
+        traits::deallocate(alloc, std::pointer_traits<typename traits::pointer>::pointer_to(*ptr), count);
+    }
+};
+
+
+template <typename T, typename Alloc, typename... Args>
+requires (!std::is_array_v<T>)
+unique_ptr<T, allocator_delete<T, Alloc>> allocate_unique(const Alloc& alloc, Args&&... args) {
+    using deleter_type = allocator_delete<T, Alloc>;
+    using traits = typename deleter_type::traits;
+
+    typename deleter_type::allocator_type a(alloc);
+    typename traits::pointer p = traits::allocate(a, 1);
+    try {
+        traits::construct(a, std::to_address(p), std::forward<Args>(args)...);
+    } catch (...) {
+        traits::deallocate(a, p, 1);
+        throw;
+    }
+    return unique_ptr<T, deleter_type>(std::to_address(p), deleter_type(a));
+}
+
+template <typename T, typename Alloc>
+requires std::is_unbounded_array_v<T>
+unique_ptr<T, allocator_delete<T, Alloc>> allocate_unique(const Alloc& alloc, std::size_t n) {
+    using deleter_type = allocator_delete<T, Alloc>;
+    using traits = typename deleter_type::traits;
+
+    typename deleter_type::allocator_type a(alloc);
+    typename traits::pointer p = traits::allocate(a, n);
+    std::size_t i = 0;
+    try {
+        for (; i < n; ++i) {
+            traits::construct(a, std::to_address(p) + i);
+        }
+    } catch (...) {
+        for (std::size_t j = 0; j < i; ++j) {
+            traits::destroy(a, std::to_address(p) + j);
+        }
+        traits::deallocate(a, p, n);
+        throw;
+    }
+    return unique_ptr<T, deleter_type>(std::to_address(p), deleter_type(a, n));
+}
+
+template <typename T, typename Alloc, typename... Args>
+requires std::is_bounded_array_v<T>
+void allocate_unique(const Alloc&, Args&&...) = delete;
\ No newline at end of file
@@ -0,0 +1,353 @@
+#pragma once
+#include <iostream>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../iterator.h"
+
+
+/*
+    RAII-обёртки для ресурсов, которые не являются указателями: файловых дескрипторов и отображений файлов в память.
+
+    unique_handle<Handle, Deleter> устроен как unique_ptr, но "пустым" значением служит не nullptr, а значение, которое
+    возвращает Deleter::null() (для дескриптора это -1, для mmap - MAP_FAILED). Deleter освобождает ресурс и при пустом
+    deleter'е handle занимает ровно столько же, сколько сам Handle: unique_fd - это один int.
+
+    unique_mapping - отображение файла. munmap требует длину, поэтому она хранится в deleter'е: отображение занимает указатель
+    и размер (как span), а не одно слово - иначе длину пришлось бы держать в самом отображении.
+
+    map_file() отображает файл только для чтения. Содержимое можно получить как span<const T> (as_span) или передать во
+    владение mapped_array<T> - контейнер с интерфейсом константного vector'а, который читает данные прямо из страниц файла,
+    без копирования в кучу.
+*/
+
+
+template <typename Handle, typename Deleter>
+class unique_handle {
+    Handle handle_;
+    [[no_unique_address]] Deleter deleter_;
+
+    public:
+
+    using handle_type = Handle;
+    using deleter_type = Deleter;
+
+
+
+    // Constructors
+
+    unique_handle() noexcept : handle_(Deleter::null()) {}
+
+    explicit unique_handle(Handle h) noexcept : handle_(h) {}
+
+    unique_handle(Handle h, const Deleter& d) noexcept(std::is_nothrow_copy_constructible_v<Deleter>) : handle_(h), deleter_(d) {}
+
+    unique_handle(unique_handle&& other) noexcept(std::is_nothrow_move_constructible_v<Deleter>)
+    : handle_(std::exchange(other.handle_, Deleter::null())), deleter_(std::move(other.deleter_)) {}
+
+    unique_handle(const unique_handle&) = delete;
+
+
+
+    // Destructor
+
+    ~unique_handle() {
+        if (handle_ != Deleter::null()) {
+            deleter_(handle_);
+        }
+    }
+
+
+
+    // Assignment
+
+    unique_handle& operator=(unique_handle&& other) noexcept(std::is_nothrow_move_assignable_v<Deleter>) {
+        if (this != std::addressof(other)) {
+            reset(other.release());
+            deleter_ = std::move(other.deleter_);
+        }
+        return *this;
+    }
+
+    unique_handle& operator=(const unique_handle&) = delete;
+
+
+
+    // Modifiers
+
+    void reset(Handle h = Deleter::null()) noexcept {
+        Handle old = std::exchange(handle_, h);
+        if (old != Deleter::null()) {
+            deleter_(old);
+        }
+    }
+
+    Handle release() noexcept {
+        return std::exchange(handle_, Deleter::null());
+    }
+
+    void swap(unique_handle& other) noexcept(std::is_nothrow_swappable_v<Deleter>) {
+        std::swap(handle_, other.handle_);
+        std::swap(deleter_, other.deleter_);
+    }
+
+
+
+    // Observers
+
+    Handle get() const noexcept {
+        return handle_;
+    }
+
+    Deleter& get_deleter() noexcept {
+        return deleter_;
+    }
+
+    const Deleter& get_deleter() const noexcept {
+        return deleter_;
+    }
+
+    explicit operator bool() const noexcept {
+        return handle_ != Deleter::null();
+    }
+};
+
+
+template <typename Handle, typename Deleter>
+void swap(unique_handle<Handle, Deleter>& lhs, unique_handle<Handle, Deleter>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+    lhs.swap(rhs);
+}
+
+
+
+struct fd_close {
+    static constexpr int null() noexcept {
+        return -1;
+    }
+
+    void operator()(int fd) const noexcept {
+        ::close(fd);
+    }
+};
+
+using unique_fd = unique_handle<int, fd_close>;
+
+static_assert(sizeof(unique_fd) == sizeof(int));
+
+
+inline unique_fd open_file(const char* path, int flags = O_RDONLY | O_CLOEXEC, mode_t mode = 0644) {
+    int fd = ::open(path, flags, mode);
+    if (fd == -1) {
+        throw std::system_error(errno, std::generic_category(), "open");
+    }
+    return unique_fd(fd);
+}
+
+
+
+struct munmap_delete {
+    std::size_t length = 0;
+
+    static void* null() noexcept {
+        return MAP_FAILED;
+    }
+
+    void operator()(void* addr) const noexcept {
+        ::munmap(addr, length);
+    }
+};
+
+
+class unique_mapping {
+    unique_handle<void*, munmap_delete> handle_;
+
+    public:
+
+    unique_mapping() noexcept = default;
+
+    // Принимает владение результатом mmap(addr, length, ...)
+    unique_mapping(void* addr, std::size_t length) noexcept : handle_(addr, munmap_delete{length}) {}
+
+    unique_mapping(unique_mapping&& other) noexcept : handle_(std::move(other.handle_)) {
+        other.handle_.get_deleter().length = 0;
+    }
+
+    unique_mapping& operator=(unique_mapping&& other) noexcept {
+        if (this != &other) {
+            handle_ = std::move(other.handle_);
+            other.handle_.get_deleter().length = 0;
+        }
+        return *this;
+    }
+
+    void reset() noexcept {
+        handle_.reset();
+        handle_.get_deleter().length = 0;
+    }
+
+    const std::byte* data() const noexcept {
+        return handle_ ? static_cast<const std::byte*>(handle_.get()) : nullptr;
+    }
+
+    std::size_t size() const noexcept {
+        return handle_.get_deleter().length;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    explicit operator bool() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    std::span<const std::byte> bytes() const noexcept {
+        return {data(), size()};
+    }
+
+    // Представляет отображение как массив T; размер и выравнивание должны подходить под T
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    std::span<const T> as_span() const {
+        if (size() % sizeof(T) != 0) {
+            throw std::invalid_argument("mapping size is not a multiple of the element size");
+        }
+        if (reinterpret_cast<std::uintptr_t>(data()) % alignof(T) != 0) {
+            throw std::invalid_argument("mapping is not aligned for the element type");
+        }
+        return {reinterpret_cast<const T*>(data()), size() / sizeof(T)};
+    }
+
+    // Подсказка ядру о характере доступа (MADV_SEQUENTIAL, MADV_WILLNEED, ...)
+    void advise(int advice) const noexcept {
+        if (handle_) {
+            ::madvise(handle_.get(), size(), advice);
+        }
+    }
+};
+
+
+// Отображает файл целиком только для чтения. Пустой файл даёт пустое отображение (mmap нулевой длины недопустим)
+inline unique_mapping map_file(const char* path) {
+    unique_fd fd = open_file(path);
+
+    struct stat st;
+    if (::fstat(fd.get(), &st) == -1) {
+        throw std::system_error(errno, std::generic_category(), "fstat");
+    }
+
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        return unique_mapping();
+    }
+
+    // После mmap дескриптор можно закрыть - отображение держит файл само
+    void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (addr == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    return unique_mapping(addr, size);
+}
+
+
+
+// Неизменяемый контейнер поверх отображения: итераторы те же, что у const_iterator нашего vector'а
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+class mapped_array {
+    unique_mapping mapping_;
+    std::span<const T> view_;
+
+    public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const T&;
+    using const_reference = const T&;
+    using pointer = const T*;
+    using const_pointer = const T*;
+    using iterator = ::base_iterator<true, T>;
+    using const_iterator = ::base_iterator<true, T>;
+
+    mapped_array() noexcept = default;
+
+    explicit mapped_array(unique_mapping&& mapping) : view_(mapping.as_span<T>()) {
+        mapping_ = std::move(mapping);
+    }
+
+    explicit mapped_array(const char* path) : mapped_array(map_file(path)) {}
+
+    mapped_array(mapped_array&& other) noexcept
+    : mapping_(std::move(other.mapping_)), view_(std::exchange(other.view_, std::span<const T>())) {}
+
+    mapped_array& operator=(mapped_array&& other) noexcept {
+        mapping_ = std::move(other.mapping_);
+        view_ = std::exchange(other.view_, std::span<const T>());
+        return *this;
+    }
+
+    const T* data() const noexcept {
+        return view_.data();
+    }
+
+    size_type size() const noexcept {
+        return view_.size();
+    }
+
+    bool empty() const noexcept {
+        return view_.empty();
+    }
+
+    const T& operator[](size_type i) const noexcept {
+        return view_[i];
+    }
+
+    const T& at(size_type i) const {
+        if (i >= size()) {
+            throw std::out_of_range("mapped_array::at");
+        }
+        return view_[i];
+    }
+
+    const T& front() const noexcept {
+        return view_.front();
+    }
+
+    const T& back() const noexcept {
+        return view_.back();
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(data());
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(data() + size());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    std::span<const T> span() const noexcept {
+        return view_;
+    }
+
+    const unique_mapping& mapping() const noexcept {
+        return mapping_;
+    }
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include "vector.h"
+#include "thread_pool.h"
+
+
+/*
+    Сортировки vector'а, использующие все ядра пула.
+
+    parallel_sort / parallel_stable_sort - сортировка слиянием: куски сортируются независимо (std::sort или std::stable_sort),
+    затем сливаются параллельным слиянием - большую из двух сливаемых частей делим пополам, во второй бинарным поиском находим
+    соответствующую точку, и две половины сливаются независимо. Буфер и исходный вектор меняются ролями на каждом уровне,
+    поэтому каждый элемент перемещается один раз на уровень. Слияние устойчиво, так что parallel_stable_sort устойчива целиком.
+
+    radix_sort - поразрядная LSD сортировка по ключу key(x) (целое или число с плавающей точкой): по байту за проход,
+    проходы, в которых все ключи имеют одинаковый байт, пропускаются. Устойчива. Каждый проход параллелится по блокам:
+    гистограммы блоков считаются независимо, а префиксные суммы в порядке (байт, блок) дают каждому блоку свои позиции.
+    Порядок чисел с плавающей точкой - как у битового представления с исправленным знаком: -0.0 < +0.0, NaN - по краям.
+
+    Буфер берётся у аллокатора сортируемого вектора: это vector<T, Alloc> с get_allocator() исходного. Он заполняется
+    перемещением элементов, поэтому T достаточно быть перемещаемым, конструктор по умолчанию не нужен.
+*/
+
+
+template <typename T, typename Alloc, typename Instrumentation, typename Compare, bool Stable>
+class parallel_merge_sorter {
+    thread_pool& pool_;
+    Compare& comp_;
+    std::size_t sort_cutoff_;
+
+    static constexpr std::size_t merge_cutoff = 4096;
+
+    void sort_leaf(T* first, T* last) {
+        if constexpr (Stable) {
+            std::stable_sort(first, last, comp_);
+        } else {
+            std::sort(first, last, comp_);
+        }
+    }
+
+    void merge(T* first1, T* last1, T* first2, T* last2, T* out) {
+        std::size_t n1 = static_cast<std::size_t>(last1 - first1);
+        std::size_t n2 = static_cast<std::size_t>(last2 - first2);
+        if (n1 + n2 <= merge_cutoff) {
+            // Свой цикл вместо std::merge с move_iterator: компаратор получает lvalue, как и в std::sort
+            while (first1 != last1 && first2 != last2) {
+                if (comp_(*first2, *first1)) {
+                    *out++ = std::move(*first2++);
+                } else {
+                    *out++ = std::move(*first1++);
+                }
+            }
+            out = std::move(first1, last1, out);
+            std::move(first2, last2, out);
+            return;
+        }
+
+        // Равные элементы первой части должны остаться левее равных из второй: отсюда lower_bound / upper_bound
+        T* mid1;
+        T* mid2;
+        if (n1 >= n2) {
+            mid1 = first1 + n1 / 2;
+            mid2 = std::lower_bound(first2, last2, *mid1, comp_);
+        } else {
+            mid2 = first2 + n2 / 2;
+            mid1 = std::upper_bound(first1, last1, *mid2, comp_);
+        }
+
+        task_group group(pool_);
+        group.run([=, this] {
+            merge(first1, mid1, first2, mid2, out);
+        });
+        merge(mid1, last1, mid2, last2, out + (mid1 - first1) + (mid2 - first2));
+        group.wait();
+    }
+
+    // Сортирует [src, src + n); результат оказывается в dst, если to_dst, иначе в src. Вторая область служит буфером
+    void sort(T* src, T* dst, std::size_t n, bool to_dst) {
+        if (n <= sort_cutoff_) {
+            if (to_dst) {
+                std::move(src, src + n, dst);
+                sort_leaf(dst, dst + n);
+            } else {
+                sort_leaf(src, src + n);
+            }
+            return;
+        }
+
+        std::size_t half = n / 2;
+        task_group group(pool_);
+        group.run([=, this] {
+            sort(src, dst, half, !to_dst);
+        });
+        sort(src + half, dst + half, n - half, !to_dst);
+        group.wait();
+
+        T* from = to_dst ? src : dst;
+        T* to = to_dst ? dst : src;
+        merge(from, from + half, from + half, from + n, to);
+    }
+
+    public:
+
+    parallel_merge_sorter(thread_pool& pool, Compare& comp, std::size_t n) noexcept
+    : pool_(pool), comp_(comp), sort_cutoff_(std::max<std::size_t>(8192, n / (pool.size() * 4))) {}
+
+    void operator()(vector<T, Alloc, Instrumentation>& v) {
+        std::size_t n = v.size();
+        if (n <= sort_cutoff_ || pool_.size() == 1) {
+            sort_leaf(v.data(), v.data() + n);
+            return;
+        }
+
+        // Данные переезжают в буфер, и сортировка возвращает их в исходный вектор
+        vector<T, Alloc> scratch(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()), v.get_allocator());
+        sort(scratch.data(), v.data(), n, true);
+    }
+};
+
+
+template <typename T, typename Alloc, typename Instrumentation, typename Compare = std::less<>>
+void parallel_sort(vector<T, Alloc, Instrumentation>& v, Compare comp = {}, thread_pool& pool = thread_pool::global()) {
+    parallel_merge_sorter<T, Alloc, Instrumentation, Compare, false>(pool, comp, v.size())(v);
+}
+
+template <typename T, typename Alloc, typename Instrumentation, typename Compare = std::less<>>
+void parallel_stable_sort(vector<T, Alloc, Instrumentation>& v, Compare comp = {}, thread_pool& pool = thread_pool::global()) {
+    parallel_merge_sorter<T, Alloc, Instrumentation, Compare, true>(pool, comp, v.size())(v);
+}
+
+
+
+template <typename Key>
+concept radix_key = (std::integral<Key> && !std::same_as<Key, bool>) ||
+                    (std::floating_point<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8) && std::numeric_limits<Key>::is_iec559);
+
+// Беззнаковое число, сравнение которого совпадает со сравнением ключей
+template <radix_key Key>
+constexpr auto radix_ordered_bits(Key key) noexcept {
+    if constexpr (std::floating_point<Key>) {
+        using bits_type = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+        constexpr bits_type sign = bits_type(1) << (sizeof(Key) * 8 - 1);
+        bits_type bits = std::bit_cast<bits_type>(key);
+        return (bits & sign) ? bits_type(~bits) : bits_type(bits | sign);
+    } else if constexpr (std::is_signed_v<Key>) {
+        using bits_type = std::make_unsigned_t<Key>;
+        return static_cast<bits_type>(static_cast<bits_type>(key) ^ (bits_type(1) << (sizeof(Key) * 8 - 1)));
+    } else {
+        return key;
+    }
+}
+
+
+template <typename T, typename Alloc, typename Instrumentation, typename KeyFn = std::identity>
+requires radix_key<std::remove_cvref_t<std::invoke_result_t<KeyFn&, const T&>>>
+void radix_sort(vector<T, Alloc, Instrumentation>& v, KeyFn key = {}, thread_pool& pool = thread_pool::global()) {
+    using key_type = std::remove_cvref_t<std::invoke_result_t<KeyFn&, const T&>>;
+    constexpr std::size_t radix = 256;
+    constexpr std::size_t passes = sizeof(key_type);
+    // Меньше этого на блок параллелить проход невыгодно
+    constexpr std::size_t min_block = 1 << 16;
+
+    std::size_t n = v.size();
+    if (n < 2) {
+        return;
+    }
+
+    std::size_t blocks = std::clamp<std::size_t>(n / min_block, 1, pool.size() * 4);
+    std::size_t block_size = (n + blocks - 1) / blocks;
+    blocks = (n + block_size - 1) / block_size;
+
+    auto digit = [&key](const T& x, std::size_t pass) noexcept {
+        return static_cast<std::size_t>((radix_ordered_bits(static_cast<key_type>(std::invoke(key, x))) >> (pass * 8)) & 0xFF);
+    };
+
+    // Запускает body(block, first, last) для каждого блока; при одном блоке - в текущем потоке
+    auto for_each_block = [&](auto&& body) {
+        if (blocks == 1) {
+            body(0, 0, n);
+            return;
+        }
+        task_group group(pool);
+        for (std::size_t b = 1; b < blocks; ++b) {
+            group.run([&body, b, block_size, n] {
+                body(b, b * block_size, std::min(n, (b + 1) * block_size));
+            });
+        }
+        body(0, 0, std::min(n, block_size));
+        group.wait();
+    };
+
+    // Буфер без политики наблюдения: это не выделение памяти вектором вызывающего
+    vector<T, Alloc> scratch(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()), v.get_allocator());
+    T* src = scratch.data();
+    T* dst = v.data();
+    bool in_scratch = true;
+
+    vector<std::array<std::size_t, radix>> counts(blocks);
+
+    for (std::size_t pass = 0; pass < passes; ++pass) {
+        for_each_block([&](std::size_t b, std::size_t first, std::size_t last) {
+            std::array<std::size_t, radix>& hist = counts[b];
+            hist.fill(0);
+            for (std::size_t i = first; i < last; ++i) {
+                ++hist[digit(src[i], pass)];
+            }
+        });
+
+        // Если все ключи попали в одну корзину, проход ничего не меняет
+        bool trivial = false;
+        for (std::size_t d = 0; d < radix && !trivial; ++d) {
+            std::size_t total = 0;
+            for (std::size_t b = 0; b < blocks; ++b) {
+                total += counts[b][d];
+            }
+            trivial = total == n;
+        }
+        if (trivial) {
+            continue;
+        }
+
+        // Превращаем гистограммы в начальные позиции: сначала по байту, внутри байта - по порядку блоков
+        std::size_t offset = 0;
+        for (std::size_t d = 0; d < radix; ++d) {
+            for (std::size_t b = 0; b < blocks; ++b) {
+                std::size_t c = counts[b][d];
+                counts[b][d] = offset;
+                offset += c;
+            }
+        }
+
+        for_each_block([&](std::size_t b, std::size_t first, std::size_t last) {
+            std::array<std::size_t, radix>& pos = counts[b];
+            for (std::size_t i = first; i < last; ++i) {
+                dst[pos[digit(src[i], pass)]++] = std::move(src[i]);
+            }
+        });
+
+        std::swap(src, dst);
+        in_scratch = !in_scratch;
+    }
+
+    // Обменять буферы нельзя: у scratch другой тип, поэтому после нечётного числа проходов данные переносятся обратно
+    if (in_scratch) {
+        std::move(scratch.begin(), scratch.end(), v.begin());
+    }
+}
@@ -0,0 +1,461 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/*
+    Пул потоков с перехватом работы (work stealing).
+
+    У каждого рабочего потока своя двусторонняя очередь Чейза-Лева: владелец кладёт и забирает задачи с нижнего конца без
+    блокировок (LIFO - свежие задачи ещё горячие в кэше), остальные потоки крадут с верхнего конца (FIFO - самые старые и,
+    как правило, самые крупные куски работы). Задачи, отправленные извне пула, попадают в общую очередь под мьютексом.
+
+    Простаивающий поток сначала пытается украсть работу у соседей, а если её нет - засыпает на atomic::wait. Постановка
+    задачи увеличивает счётчик сигналов и будит спящие потоки, только если такие есть, поэтому в нагруженном пуле отправка
+    задачи не делает системных вызовов.
+
+    task_group - группа задач с ожиданием. wait() не просто блокируется: ожидающий поток сам выполняет задачи из очередей
+    пула, пока группа не опустеет. Поэтому вложенный параллелизм (задача создаёт группу и ждёт её) не приводит к
+    взаимоблокировке и не простаивает ядро. Первое исключение из задач группы пробрасывается из wait().
+*/
+
+
+class pool_task {
+    public:
+
+    // Выполняет задачу и освобождает её
+    virtual void run() noexcept = 0;
+    virtual ~pool_task() = default;
+};
+
+
+template <typename F>
+class function_task final : public pool_task {
+    F fn_;
+
+    public:
+
+    explicit function_task(F&& fn) : fn_(std::move(fn)) {}
+
+    void run() noexcept override {
+        fn_();
+        delete this;
+    }
+};
+
+
+
+/*
+    Очередь Чейза-Лева ("Dynamic Circular Work-Stealing Deque", 2005; порядки памяти - по Lê et al., 2013, с seq_cst
+    операциями вместо отдельных барьеров). push/pop вызывает только владелец, steal - любой поток. При переполнении буфер
+    удваивается; старые буферы живут до разрушения очереди, потому что вор мог успеть прочитать указатель на них.
+*/
+class work_stealing_deque {
+    struct buffer {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<pool_task*>[]> slots;
+
+        explicit buffer(std::int64_t capacity_)
+        : capacity(capacity_), slots(new std::atomic<pool_task*>[static_cast<std::size_t>(capacity_)]) {}
+
+        pool_task* get(std::int64_t i) const noexcept {
+            return slots[static_cast<std::size_t>(i & (capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, pool_task* t) noexcept {
+            slots[static_cast<std::size_t>(i & (capacity - 1))].store(t, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<buffer*> buffer_;
+    std::vector<std::unique_ptr<buffer>> buffers_;
+
+    buffer* grow(buffer* old, std::int64_t top, std::int64_t bottom) {
+        auto bigger = std::make_unique<buffer>(old->capacity * 2);
+        for (std::int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        buffer* raw = bigger.get();
+        buffers_.push_back(std::move(bigger));
+        buffer_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    public:
+
+    explicit work_stealing_deque(std::int64_t capacity = 256) {
+        buffers_.push_back(std::make_unique<buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    // Только владелец
+    void push(pool_task* t) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        buffer* buf = buffer_.load(std::memory_order_relaxed);
+        if (b - top >= buf->capacity) {
+            buf = grow(buf, top, b);
+        }
+        buf->put(b, t);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Только владелец
+    pool_task* pop() noexcept {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        buffer* buf = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        pool_task* task = buf->get(b);
+        if (t == b) {
+            // Последний элемент: соревнуемся с ворами за него
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // Любой поток
+    pool_task* steal() noexcept {
+        std::int64_t t = top_.load(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_seq_cst);
+        if (t >= b) {
+            return nullptr;
+        }
+        pool_task* task = buffer_.load(std::memory_order_acquire)->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+    // Приблизительный размер: точен только для владельца при отсутствии воров
+    std::int64_t size() const noexcept {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+};
+
+
+
+class thread_pool {
+    struct alignas(64) worker {
+        work_stealing_deque deque;
+        std::thread thread;
+    };
+
+    struct context {
+        thread_pool* pool = nullptr;
+        std::size_t index = 0;
+    };
+
+    static context& current() noexcept {
+        static thread_local context ctx;
+        return ctx;
+    }
+
+    std::vector<std::unique_ptr<worker>> workers_;
+
+    std::mutex injection_mutex_;
+    std::deque<pool_task*> injection_;
+    std::atomic<std::size_t> injected_{0};
+
+    alignas(64) std::atomic<std::uint32_t> signal_{0};
+    std::atomic<std::size_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+
+
+    /*
+        На одном счётчике спят и рабочие, и потоки в help_while. notify_one мог бы разбудить ожидающего, чьё условие уже
+        выполнено, - тот уйдёт, не взяв задачу, и она пролежит до следующего сигнала. Поэтому будим всех, но только когда
+        кто-то действительно спит: в нагруженном пуле это не происходит.
+    */
+    void notify() noexcept {
+        signal_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+            signal_.notify_all();
+        }
+    }
+
+    pool_task* take_injected() {
+        if (injected_.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        std::lock_guard lock(injection_mutex_);
+        if (injection_.empty()) {
+            return nullptr;
+        }
+        pool_task* t = injection_.front();
+        injection_.pop_front();
+        injected_.fetch_sub(1, std::memory_order_relaxed);
+        return t;
+    }
+
+    // Обход соседей начиная со следующего за собой: разные воры начинают с разных жертв
+    pool_task* steal_from_others(std::size_t self) noexcept {
+        std::size_t n = workers_.size();
+        for (std::size_t i = 1; i <= n; ++i) {
+            std::size_t victim = (self + i) % n;
+            if (victim == self && current().pool == this) {
+                continue;
+            }
+            if (pool_task* t = workers_[victim]->deque.steal()) {
+                return t;
+            }
+        }
+        return nullptr;
+    }
+
+    pool_task* find_task(std::size_t self) {
+        if (current().pool == this) {
+            if (pool_task* t = workers_[self]->deque.pop()) {
+                return t;
+            }
+        }
+        if (pool_task* t = take_injected()) {
+            return t;
+        }
+        return steal_from_others(self);
+    }
+
+    void worker_loop(std::size_t index) {
+        current() = context{this, index};
+
+        while (true) {
+            if (pool_task* t = find_task(index)) {
+                t->run();
+                continue;
+            }
+
+            // Немного покрутиться, прежде чем засыпать: новая работа часто появляется почти сразу
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; ++spin) {
+                std::this_thread::yield();
+                if (pool_task* t = find_task(index)) {
+                    t->run();
+                    found = true;
+                }
+            }
+            if (found) {
+                continue;
+            }
+
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::uint32_t seen = signal_.load(std::memory_order_seq_cst);
+            if (pool_task* t = find_task(index)) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                t->run();
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            signal_.wait(seen, std::memory_order_seq_cst);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    public:
+
+    explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<worker>());
+        }
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // Выполняет все уже поставленные задачи и останавливает потоки
+    ~thread_pool() {
+        stop_.store(true, std::memory_order_release);
+        signal_.fetch_add(1, std::memory_order_seq_cst);
+        signal_.notify_all();
+        for (auto& w : workers_) {
+            w->thread.join();
+        }
+    }
+
+    static thread_pool& global() {
+        static thread_pool instance;
+        return instance;
+    }
+
+
+    // Ставит задачу: из рабочего потока - в его собственную очередь, извне - в общую
+    template <typename F>
+    void submit(F&& fn) {
+        std::unique_ptr<pool_task> t(new function_task<std::decay_t<F>>(std::decay_t<F>(std::forward<F>(fn))));
+        context& ctx = current();
+        if (ctx.pool == this) {
+            workers_[ctx.index]->deque.push(t.get());
+        } else {
+            std::lock_guard lock(injection_mutex_);
+            injection_.push_back(t.get());
+            injected_.fetch_add(1, std::memory_order_relaxed);
+        }
+        t.release();
+        notify();
+    }
+
+    // Выполняет одну задачу из пула в текущем потоке; false - если работы не нашлось
+    bool try_run_one() {
+        context& ctx = current();
+        std::size_t self = ctx.pool == this ? ctx.index : 0;
+        if (pool_task* t = find_task(self)) {
+            t->run();
+            return true;
+        }
+        return false;
+    }
+
+    /*
+        Выполняет задачи пула в текущем потоке, пока keep_waiting() истинно. Когда работы нет, поток засыпает на том же
+        счётчике сигналов, что и рабочие: его будит и новая задача (её можно выполнить), и wake_all() от того, кто сделал
+        условие ложным.
+    */
+    template <typename Predicate>
+    void help_while(Predicate keep_waiting) {
+        while (keep_waiting()) {
+            if (try_run_one()) {
+                continue;
+            }
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::uint32_t seen = signal_.load(std::memory_order_seq_cst);
+            if (!keep_waiting()) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+            if (try_run_one()) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                continue;
+            }
+            signal_.wait(seen, std::memory_order_seq_cst);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Будит все спящие потоки, в том числе ожидающих в help_while
+    void wake_all() noexcept {
+        signal_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+            signal_.notify_all();
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return workers_.size();
+    }
+
+    // Запущен ли текущий поток этим пулом
+    bool is_worker() const noexcept {
+        return current().pool == this;
+    }
+
+    /*
+        Сколько задач ждёт в очереди текущего рабочего потока. Если там уже что-то есть, значит, соседи не успевают
+        красть, и дробить работу дальше незачем - этим пользуется адаптивное разбиение в parallel.h.
+    */
+    std::size_t local_backlog() const noexcept {
+        const context& ctx = current();
+        return ctx.pool == this ? static_cast<std::size_t>(workers_[ctx.index]->deque.size()) : 0;
+    }
+};
+
+
+
+class task_group {
+    thread_pool* pool_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr exception_;
+
+    /*
+        После уменьшения счётчика группа может быть уже разрушена ожидающим потоком, поэтому будим через пул,
+        указатель на который скопирован заранее.
+    */
+    void finish() noexcept {
+        thread_pool* pool = pool_;
+        if (pending_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+            pool->wake_all();
+        }
+    }
+
+    public:
+
+    explicit task_group(thread_pool& pool = thread_pool::global()) noexcept : pool_(&pool) {}
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    // Группа не может пережить свои задачи: они ссылаются на неё
+    ~task_group() {
+        pool_->help_while([this] { return pending_.load(std::memory_order_seq_cst) != 0; });
+    }
+
+    template <typename F>
+    void run(F&& fn) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            pool_->submit([this, fn = std::decay_t<F>(std::forward<F>(fn))]() mutable noexcept {
+                try {
+                    fn();
+                } catch (...) {
+                    if (!failed_.exchange(true, std::memory_order_acq_rel)) {
+                        exception_ = std::current_exception();
+                    }
+                }
+                finish();
+            });
+        } catch (...) {
+            finish();
+            throw;
+        }
+    }
+
+    // Помогает пулу, пока задачи группы не завершатся; затем пробрасывает первое исключение, если оно было
+    void wait() {
+        pool_->help_while([this] { return pending_.load(std::memory_order_seq_cst) != 0; });
+
+        if (failed_.exchange(false, std::memory_order_acquire)) {
+            std::exception_ptr e = std::exchange(exception_, nullptr);
+            std::rethrow_exception(e);
+        }
+    }
+
+    thread_pool& pool() const noexcept {
+        return *pool_;
+    }
+};
@@ -0,0 +1,345 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include "allocator.h"
+
+
+/*
+    tracking_allocator - адаптор, который оборачивает произвольный аллокатор (например, allocator<T> из allocator.h) и собирает
+    статистику: количество выделений и освобождений, сколько байт сейчас "живо", пиковое значение, гистограмму размеров запросов
+    по классам log2 и, при желании, счётчики по меткам (tag) - строкам, которыми помечается место создания аллокатора.
+
+    Чтобы не превращать каждый allocate в запись в общую разделяемую память (и не получить contention между потоками), счётчики
+    хранятся в thread_local блоке: пишет в него только поток-владелец, а при чтении (snapshot) блоки всех потоков складываются
+    под мьютексом. Поля блока атомарные только для того, чтобы чтение из другого потока не было гонкой данных - владелец делает
+    обычные load + store с memory_order_relaxed, без lock-префикса.
+
+    Пиковое значение живых байт считается по каждому потоку отдельно, а при объединении берётся максимум из пиков потоков и
+    текущего суммарного значения. Для контейнера, которым владеет один поток, это точный пик, в общем случае - оценка снизу.
+*/
+
+
+struct allocation_stats {
+    static constexpr std::size_t size_class_count = 64;
+
+    struct tag_stats {
+        std::string name;
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t bytes_allocated = 0;
+        std::int64_t live_bytes = 0;
+    };
+
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes_allocated = 0;
+    std::uint64_t bytes_deallocated = 0;
+    std::int64_t live_bytes = 0;
+    std::int64_t peak_bytes = 0;
+
+    // size_classes[k] - число выделений размером [2^k, 2^(k + 1)) байт
+    std::array<std::uint64_t, size_class_count> size_classes{};
+    std::vector<tag_stats> tags;
+
+    void dump(std::ostream& os) const {
+        os << "allocations: " << allocations << '\n'
+           << "deallocations: " << deallocations << '\n'
+           << "bytes allocated: " << bytes_allocated << '\n'
+           << "bytes deallocated: " << bytes_deallocated << '\n'
+           << "live bytes: " << live_bytes << '\n'
+           << "peak bytes: " << peak_bytes << '\n';
+
+        os << "size classes:\n";
+        for (std::size_t k = 0; k < size_class_count; ++k) {
+            if (size_classes[k] != 0) {
+                os << "  [" << (std::uint64_t(1) << k) << ", " << (k + 1 < size_class_count ? (std::uint64_t(1) << (k + 1)) : UINT64_MAX)
+                   << "): " << size_classes[k] << '\n';
+            }
+        }
+
+        if (!tags.empty()) {
+            os << "tags:\n";
+            for (const tag_stats& tag : tags) {
+                os << "  " << tag.name << ": allocations " << tag.allocations << ", deallocations " << tag.deallocations
+                   << ", bytes allocated " << tag.bytes_allocated << ", live bytes " << tag.live_bytes << '\n';
+            }
+        }
+    }
+};
+
+
+
+class allocation_registry {
+    public:
+
+    static constexpr std::uint32_t max_tags = 64;
+    static constexpr std::uint32_t untagged = 0;
+
+    private:
+
+    struct counters {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> deallocations{0};
+        std::atomic<std::uint64_t> bytes_allocated{0};
+        std::atomic<std::uint64_t> bytes_deallocated{0};
+    };
+
+    struct thread_block {
+        counters total;
+        counters tags[max_tags];
+        std::atomic<std::uint64_t> size_classes[allocation_stats::size_class_count]{};
+        std::atomic<std::int64_t> live{0};
+        std::atomic<std::int64_t> peak{0};
+    };
+
+    // Регистрирует блок текущего потока при первом обращении и при завершении потока переносит его счётчики в retired_
+    struct thread_handle {
+        thread_block block;
+
+        thread_handle() {
+            allocation_registry& registry = instance();
+            std::lock_guard lock(registry.mutex_);
+            registry.blocks_.push_back(&block);
+        }
+
+        ~thread_handle() {
+            allocation_registry& registry = instance();
+            std::lock_guard lock(registry.mutex_);
+            merge_into(registry.retired_, block);
+            std::erase(registry.blocks_, &block);
+        }
+    };
+
+    std::mutex mutex_;
+    std::vector<thread_block*> blocks_;
+    thread_block retired_;
+    std::vector<std::string> tag_names_{std::string()};
+
+
+    static allocation_registry& instance() {
+        static allocation_registry registry;
+        return registry;
+    }
+
+    static thread_block& local() {
+        thread_local thread_handle handle;
+        return handle.block;
+    }
+
+    // Пишет только поток-владелец, поэтому read-modify-write не нужен
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t n) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static void merge_into(thread_block& to, const thread_block& from) noexcept {
+        auto add = [](std::atomic<std::uint64_t>& x, const std::atomic<std::uint64_t>& y) {
+            x.store(x.load(std::memory_order_relaxed) + y.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        };
+        auto add_counters = [&add](counters& x, const counters& y) {
+            add(x.allocations, y.allocations);
+            add(x.deallocations, y.deallocations);
+            add(x.bytes_allocated, y.bytes_allocated);
+            add(x.bytes_deallocated, y.bytes_deallocated);
+        };
+
+        add_counters(to.total, from.total);
+        for (std::uint32_t i = 0; i < max_tags; ++i) {
+            add_counters(to.tags[i], from.tags[i]);
+        }
+        for (std::size_t k = 0; k < allocation_stats::size_class_count; ++k) {
+            add(to.size_classes[k], from.size_classes[k]);
+        }
+        to.live.store(to.live.load(std::memory_order_relaxed) + from.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.peak.store(std::max(to.peak.load(std::memory_order_relaxed), from.peak.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    }
+
+    public:
+
+    // Возвращает индекс метки, одинаковые строки получают один и тот же индекс. Если меток больше max_tags, лишние считаются без метки
+    static std::uint32_t tag_index(const char* name) {
+        if (name == nullptr || *name == '\0') {
+            return untagged;
+        }
+
+        allocation_registry& registry = instance();
+        std::lock_guard lock(registry.mutex_);
+        for (std::uint32_t i = 1; i < registry.tag_names_.size(); ++i) {
+            if (registry.tag_names_[i] == name) {
+                return i;
+            }
+        }
+        if (registry.tag_names_.size() == max_tags) {
+            return untagged;
+        }
+        registry.tag_names_.emplace_back(name);
+        return static_cast<std::uint32_t>(registry.tag_names_.size() - 1);
+    }
+
+    static void record_allocation(std::size_t bytes, std::uint32_t tag) noexcept {
+        thread_block& block = local();
+        bump(block.total.allocations, 1);
+        bump(block.total.bytes_allocated, bytes);
+        bump(block.tags[tag].allocations, 1);
+        bump(block.tags[tag].bytes_allocated, bytes);
+        bump(block.size_classes[bytes == 0 ? 0 : std::bit_width(bytes) - 1], 1);
+
+        std::int64_t live = block.live.load(std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+        block.live.store(live, std::memory_order_relaxed);
+        if (live > block.peak.load(std::memory_order_relaxed)) {
+            block.peak.store(live, std::memory_order_relaxed);
+        }
+    }
+
+    static void record_deallocation(std::size_t bytes, std::uint32_t tag) noexcept {
+        thread_block& block = local();
+        bump(block.total.deallocations, 1);
+        bump(block.total.bytes_deallocated, bytes);
+        bump(block.tags[tag].deallocations, 1);
+        bump(block.tags[tag].bytes_deallocated, bytes);
+        block.live.store(block.live.load(std::memory_order_relaxed) - static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    static allocation_stats snapshot() {
+        allocation_registry& registry = instance();
+        std::lock_guard lock(registry.mutex_);
+
+        thread_block merged;
+        merge_into(merged, registry.retired_);
+        std::int64_t peak = registry.retired_.peak.load(std::memory_order_relaxed);
+        for (const thread_block* block : registry.blocks_) {
+            merge_into(merged, *block);
+        }
+
+        allocation_stats stats;
+        stats.allocations = merged.total.allocations.load(std::memory_order_relaxed);
+        stats.deallocations = merged.total.deallocations.load(std::memory_order_relaxed);
+        stats.bytes_allocated = merged.total.bytes_allocated.load(std::memory_order_relaxed);
+        stats.bytes_deallocated = merged.total.bytes_deallocated.load(std::memory_order_relaxed);
+        stats.live_bytes = merged.live.load(std::memory_order_relaxed);
+
+        peak = std::max({peak, merged.peak.load(std::memory_order_relaxed), stats.live_bytes});
+        registry.retired_.peak.store(peak, std::memory_order_relaxed);
+        stats.peak_bytes = peak;
+
+        for (std::size_t k = 0; k < allocation_stats::size_class_count; ++k) {
+            stats.size_classes[k] = merged.size_classes[k].load(std::memory_order_relaxed);
+        }
+
+        for (std::uint32_t i = 1; i < registry.tag_names_.size(); ++i) {
+            const counters& tag = merged.tags[i];
+            allocation_stats::tag_stats& out = stats.tags.emplace_back();
+            out.name = registry.tag_names_[i];
+            out.allocations = tag.allocations.load(std::memory_order_relaxed);
+            out.deallocations = tag.deallocations.load(std::memory_order_relaxed);
+            out.bytes_allocated = tag.bytes_allocated.load(std::memory_order_relaxed);
+            out.live_bytes = static_cast<std::int64_t>(out.bytes_allocated) - static_cast<std::int64_t>(tag.bytes_deallocated.load(std::memory_order_relaxed));
+        }
+        return stats;
+    }
+
+    static void dump(std::ostream& os = std::cout) {
+        snapshot().dump(os);
+    }
+};
+
+
+
+template <typename Alloc = allocator<char>>
+class tracking_allocator {
+    using traits = std::allocator_traits<Alloc>;
+
+    [[no_unique_address]] Alloc inner_;
+    std::uint32_t tag_;
+
+    public:
+
+    using value_type = typename traits::value_type;
+    using pointer = typename traits::pointer;
+    using const_pointer = typename traits::const_pointer;
+    using size_type = typename traits::size_type;
+    using difference_type = typename traits::difference_type;
+    using propagate_on_container_copy_assignment = typename traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment = typename traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename traits::propagate_on_container_swap;
+    using is_always_equal = typename traits::is_always_equal;
+
+    template <typename U>
+    struct rebind {
+        using other = tracking_allocator<typename traits::template rebind_alloc<U>>;
+    };
+
+    template <typename OtherAlloc>
+    friend class tracking_allocator;
+
+
+    tracking_allocator() noexcept(std::is_nothrow_default_constructible_v<Alloc>) : inner_(), tag_(allocation_registry::untagged) {}
+
+    explicit tracking_allocator(const char* tag, const Alloc& inner = Alloc()) : inner_(inner), tag_(allocation_registry::tag_index(tag)) {}
+
+    explicit tracking_allocator(const Alloc& inner) noexcept : inner_(inner), tag_(allocation_registry::untagged) {}
+
+    template <typename OtherAlloc>
+    tracking_allocator(const tracking_allocator<OtherAlloc>& other) noexcept : inner_(other.inner_), tag_(other.tag_) {}
+
+
+    [[nodiscard]] pointer allocate(size_type count) {
+        pointer ptr = traits::allocate(inner_, count);
+        allocation_registry::record_allocation(count * sizeof(value_type), tag_);
+        return ptr;
+    }
+
+    void deallocate(pointer ptr, size_type count) {
+        if (ptr == nullptr) {
+            return;
+        }
+        allocation_registry::record_deallocation(count * sizeof(value_type), tag_);
+        traits::deallocate(inner_, ptr, count);
+    }
+
+    template <typename U, typename ... Args>
+    void construct(U* ptr, Args&& ... args) {
+        traits::construct(inner_, ptr, std::forward<Args>(args) ...);
+    }
+
+    template <typename U>
+    void destroy(U* ptr) {
+        traits::destroy(inner_, ptr);
+    }
+
+    size_type max_size() const noexcept {
+        return traits::max_size(inner_);
+    }
+
+    tracking_allocator select_on_container_copy_construction() const {
+        tracking_allocator copy(traits::select_on_container_copy_construction(inner_));
+        copy.tag_ = tag_;
+        return copy;
+    }
+
+    const Alloc& inner_allocator() const noexcept {
+        return inner_;
+    }
+
+    template <typename OtherAlloc>
+    bool operator==(const tracking_allocator<OtherAlloc>& other) const noexcept {
+        return inner_ == other.inner_;
+    }
+
+    template <typename OtherAlloc>
+    bool operator!=(const tracking_allocator<OtherAlloc>& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+
+// construct только пересылает вызов внутреннему аллокатору, поэтому тривиален ровно тогда, когда тривиален его construct
+template <typename Alloc>
+struct has_trivial_construct<tracking_allocator<Alloc>> : has_trivial_construct<Alloc> {};
@@ -1,17 +1,120 @@
 #pragma once
 #include <iostream>
+#include <cassert>
 #include <ranges>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "iterator.h"
 #include "allocator.h"
 #include "reverse_iterator.h"
 
 
-template<typename T, typename Alloc = std::allocator<T>>
+/*
+    Копирование большого буфера обычным memcpy проводит весь его через кэш и вытесняет оттуда рабочие данные, хотя копия
+    (например, снимок состояния) в ближайшее время читаться не будет. Если определить VECTOR_NONTEMPORAL_THRESHOLD (в байтах),
+    копии не меньше этого размера пишутся потоковыми (non-temporal) store'ами в обход кэша. По умолчанию выключено: для копий,
+    которые сразу же читаются, это медленнее.
+*/
+#ifndef VECTOR_NONTEMPORAL_THRESHOLD
+#define VECTOR_NONTEMPORAL_THRESHOLD 0
+#endif
+
+inline void vector_copy_bytes(void* dst, const void* src, std::size_t bytes) noexcept {
+#if defined(__SSE2__) && VECTOR_NONTEMPORAL_THRESHOLD > 0
+    if (bytes >= static_cast<std::size_t>(VECTOR_NONTEMPORAL_THRESHOLD)) {
+        char* d = static_cast<char*>(dst);
+        const char* s = static_cast<const char*>(src);
+
+        // Потоковая запись требует выровненного на 16 адреса назначения
+        std::size_t head = std::min(bytes, (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % 16);
+        std::memcpy(d, s, head);
+        d += head;
+        s += head;
+        bytes -= head;
+
+        for (; bytes >= 64; d += 64, s += 64, bytes -= 64) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+            __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+        }
+        // Потоковые записи слабо упорядочены: sfence делает их видимыми раньше всего, что будет записано после
+        _mm_sfence();
+        std::memcpy(d, s, bytes);
+        return;
+    }
+#endif
+    std::memcpy(dst, src, bytes);
+}
+
+/*
+    Заполнение count объектов копиями value. Если все байты value одинаковы (нули, -1, однобайтовые типы), это memset;
+    иначе - цикл, который компилятор разворачивает в широкие векторные store'ы одного и того же значения.
+*/
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+void vector_fill_bytes(T* dst, std::size_t count, const T& value) noexcept {
+    if (count == 0) {
+        return;
+    }
+
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, std::addressof(value), sizeof(T));
+    bool uniform = true;
+    for (std::size_t i = 1; i < sizeof(T); ++i) {
+        uniform = uniform && bytes[i] == bytes[0];
+    }
+
+    if (uniform) {
+        std::memset(dst, bytes[0], count * sizeof(T));
+    } else {
+        std::uninitialized_fill_n(dst, count, value);
+    }
+}
+
+
+
+/*
+    Политика наблюдения за vector - третий параметр шаблона. vector вызывает её статические функции:
+        on_allocate<T>(capacity)                              - новый буфер без переноса (конструкторы, копирование, рост с нуля);
+        on_reallocate<T>(old_capacity, new_capacity, moved)   - рост с переносом moved существующих элементов;
+        on_shift<T>(count)                                    - вставка или удаление в середине сдвинули count элементов;
+        on_shrink_to_fit<T>(old_capacity, new_capacity, moved).
+    События сообщаются после того, как операция удалась, и не во время константного вычисления.
+
+    По умолчанию все функции пустые и inline, так что vector<T> без политики компилируется в тот же код, что и раньше.
+    Считающая реализация - vector_counting_instrumentation в vector_instrumentation.h.
+*/
+struct vector_no_instrumentation {
+    template <typename T>
+    static void on_allocate(std::size_t) noexcept {}
+
+    template <typename T>
+    static void on_reallocate(std::size_t, std::size_t, std::size_t) noexcept {}
+
+    template <typename T>
+    static void on_shift(std::size_t) noexcept {}
+
+    template <typename T>
+    static void on_shrink_to_fit(std::size_t, std::size_t, std::size_t) noexcept {}
+};
+
+
+
+template<typename T, typename Alloc = std::allocator<T>, typename Instrumentation = vector_no_instrumentation>
 class vector {
     std::size_t sz_;
     std::size_t cap_;
-    T* arr_;
+    typename std::allocator_traits<Alloc>::pointer arr_;
     [[no_unique_address]] Alloc alloc_;
 
     public:
@@ -23,8 +126,8 @@ class vector {
     using const_reference = const value_type&;
     using pointer = std::allocator_traits<Alloc>::pointer;
     using const_pointer = std::allocator_traits<Alloc>::const_pointer;
-    using iterator = ::base_iterator<false, T>;
-    using const_iterator = ::base_iterator<true, T>;
+    using iterator = ::base_iterator<false, T, pointer>;
+    using const_iterator = ::base_iterator<true, T, pointer>;
     using reverse_iterator = ::reverse_iterator<iterator>;
     using const_reverse_iterator = ::reverse_iterator<const_iterator>;
 
@@ -32,67 +135,52 @@ class vector {
 
     // Member functions
 
-    constexpr explicit vector(const Alloc& alloc = Alloc()) noexcept(noexcept(Alloc())) : alloc_(alloc), arr_(nullptr), sz_(0), cap_(0) {}
+    constexpr explicit vector(const Alloc& alloc = Alloc()) noexcept(std::is_nothrow_copy_constructible_v<Alloc>) : alloc_(alloc), arr_(nullptr), sz_(0), cap_(0) {}
 
     explicit vector(size_type count, const Alloc& alloc = Alloc()) : alloc_(alloc), arr_(nullptr), sz_(count), cap_(count) {
         if (count > 0) {
             arr_ = std::allocator_traits<Alloc>::allocate(alloc_, cap_);
-            size_type i = 0;
             try {
-                for (; i < count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i);
-                }
+                construct_default(arr_, count);
             } catch (...) {
-                for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
-                }
                 std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
                 throw;
             }
+            trace_allocate(cap_);
         }
     }
 
     constexpr vector(size_type count, const T& value, const Alloc& alloc = Alloc()) : alloc_(alloc), arr_(nullptr), sz_(count), cap_(count) {
         if (count > 0) {
             arr_ = std::allocator_traits<Alloc>::allocate(alloc_, cap_);
-            size_type i = 0;
             try {
-                for (; i < count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, value);
-                }
+                construct_fill(arr_, count, value);
             } catch (...) {
-                for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
-                }
                 std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
                 throw;
             }
+            trace_allocate(cap_);
         }
     }
 
     template <typename InputIt>
+    requires (!std::is_integral_v<InputIt>)
     constexpr vector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : alloc_(alloc), arr_(nullptr), sz_(0), cap_(0) {
         if (first != last) {
             if constexpr (std::derived_from<typename std::iterator_traits<InputIt>::iterator_category, std::forward_iterator_tag>) {
                 size_type count = std::distance(first, last);
 
-                arr_ = std::allocator_traits<Alloc>::allocate(alloc_, cap_);
-                cap_ = count;
-                sz_ = count;
-
-                size_type i = 0;
+                arr_ = std::allocator_traits<Alloc>::allocate(alloc_, count);
                 try {
-                    for (; i < count; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *first);
-                        ++first;
-                    }
+                    construct_range(arr_, first, count);
                 } catch (...) {
-                    for (size_type j = 0; j < i; ++j) {
-                        std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
-                    }
-                    std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+                    std::allocator_traits<Alloc>::deallocate(alloc_, arr_, count);
+                    arr_ = nullptr;
                     throw;
                 }
+                trace_allocate(count);
+                cap_ = count;
+                sz_ = count;
             } else {
                 while (first != last) {
                     emplace_back(*first);
@@ -105,25 +193,20 @@ class vector {
     constexpr vector(const vector& other) : alloc_(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)), arr_(nullptr), sz_(0), cap_(0) {
         if (other.sz_ > 0) {
             arr_ = std::allocator_traits<Alloc>::allocate(alloc_, other.sz_);
-            cap_ = other.sz_;
-            sz_ = other.sz_;
-
-            size_type i = 0;
             try {
-                for (; i < other.sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, other.arr_[i]);
-                }
+                construct_range(arr_, std::to_address(other.arr_), other.sz_);
             } catch (...) {
-                for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
-                }
-                std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+                std::allocator_traits<Alloc>::deallocate(alloc_, arr_, other.sz_);
+                arr_ = nullptr;
                 throw;
             }
+            trace_allocate(other.sz_);
+            cap_ = other.sz_;
+            sz_ = other.sz_;
         }
     }
 
-    constexpr vector(vector&& other) noexcept : alloc_(std::allocator_traits<Alloc>::select_on_container_move_construction(other.alloc_)), arr_(other.arr_), sz_(other.sz_), cap_(other.cap_) {
+    constexpr vector(vector&& other) noexcept : alloc_(std::move(other.alloc_)), arr_(other.arr_), sz_(other.sz_), cap_(other.cap_) {
         other.arr_ = nullptr;
         other.sz_ = 0;
         other.cap_ = 0;
@@ -131,29 +214,21 @@ class vector {
 
     constexpr vector(std::initializer_list<T> init, const Alloc& alloc = Alloc()) : alloc_(alloc), arr_(nullptr), sz_(init.size()), cap_(init.size()) {
         if (init.size() > 0) {
-            typename std::initializer_list<T>::iterator it = init.begin();
-
             arr_ = std::allocator_traits<Alloc>::allocate(alloc_, cap_);
-            size_type i = 0;
             try {
-                for (; i < init.size(); ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *it);
-                    ++it;
-                }
+                construct_range(arr_, init.begin(), init.size());
             } catch (...) {
-                for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
-                }
                 std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
                 throw;
             }
+            trace_allocate(cap_);
         }
     }
 
     ~vector() noexcept {
         if constexpr (!std::is_trivially_destructible_v<T>) {
             for (size_type i = 0; i < sz_; ++i) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
             }
         }
         std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
@@ -167,25 +242,17 @@ class vector {
 
     void assign(size_type count, const T& value) {
         if (cap_ >= count) {
-            if (sz_ >= count) {
-                for (size_type i = 0; i < sz_; ++i) {
-                    arr_[i] = value;
-                }
-                for (size_type i = count; i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                }
+            size_type common = std::min(sz_, count);
+            std::fill_n(std::to_address(arr_), common, value);
+            if (sz_ > count) {
+                destroy_tail(count);
             } else {
-                for (size_type i = 0; i < sz_; ++i) {
-                    arr_[i] = value;
-                }
-                for (size_type i = sz_; i < count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, value);
-                }
+                construct_fill(arr_ + sz_, count - sz_, value);
             }
             sz_ = count;
         } else {
             vector tmp(count, value, alloc_);
-            swap(*this, tmp);
+            swap(tmp);
         }
     }
 
@@ -200,40 +267,27 @@ class vector {
         if constexpr (std::derived_from<typename std::iterator_traits<InputIt>::iterator_category, std::forward_iterator_tag>) {
             size_type count = std::distance(first, last);
 
-            std::optional<vector<value_type>> copy_range;
-            const_pointer val_ptr = std::addressof(*first);
-            bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, arr_ + sz_) && std::greater_equal<const T*>()(val_ptr, arr_));
-            if (value_inside_vector) {
-                copy_range.emplace();
-                for (InputIt it = first; it != last; ++it) {
-                    copy_range->push_back(*it);
-                }
-                val_ptr = copy_range->data();
+            // Диапазон из нашего же буфера (в том числе через rbegin/rend): копируем его в новый вектор, иначе присваивание
+            // перетрёт ещё не прочитанное
+            bool range_inside_vector = false;
+            using reference = std::iter_reference_t<InputIt>;
+            if constexpr (std::is_lvalue_reference_v<reference> && std::is_same_v<std::remove_cvref_t<reference>, T>) {
+                const T* val_ptr = std::addressof(*first);
+                range_inside_vector = arr_ && (std::less<const T*>()(val_ptr, std::to_address(arr_) + sz_) && std::greater_equal<const T*>()(val_ptr, std::to_address(arr_)));
             }
 
-            if (cap_ >= count) {
-                if (sz_ >= count) {
-                    for (size_type i = 0; i < sz_; ++i) {
-                        arr_[i] = *val_ptr;
-                        ++val_ptr;
-                    }
-                    for (size_type i = count; i < sz_; ++i) {
-                        std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                    }
+            if (cap_ >= count && !range_inside_vector) {
+                size_type common = std::min(sz_, count);
+                first = assign_range(arr_, first, common);
+                if (sz_ > count) {
+                    destroy_tail(count);
                 } else {
-                    for (size_type i = 0; i < sz_; ++i) {
-                        arr_[i] = *val_ptr;
-                        ++val_ptr;
-                    }
-                    for (size_type i = sz_; i < count; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *val_ptr);
-                        ++val_ptr;
-                    }
+                    construct_range(arr_ + sz_, first, count - sz_);
                 }
                 sz_ = count;
             } else {
                 vector tmp(first, last, alloc_);
-                swap(*this, tmp);
+                swap(tmp);
             }
         } else {
             clear();
@@ -245,32 +299,7 @@ class vector {
     }
 
     void assign(std::initializer_list<T> ilist) {
-        typename std::initializer_list<T>::iterator it = ilist.begin();
-        size_type count = ilist.size();
-        if (cap_ >= count) {
-            if (sz_ >= count) {
-                for (size_type i = 0; i < sz_; ++i) {
-                    arr_[i] = *it;
-                    ++it;
-                }
-                for (size_type i = count; i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                }
-            } else {
-                for (size_type i = 0; i < sz_; ++i) {
-                    arr_[i] = *it;
-                    ++it;
-                }
-                for (size_type i = sz_; i < count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *it);
-                    ++it;
-                }
-            }
-            sz_ = count;
-        } else {
-            vector tmp(ilist, alloc_);
-            swap(*this, tmp);
-        }
+        assign(ilist.begin(), ilist.end());
     }
 
     allocator_type get_allocator() const {
@@ -282,61 +311,45 @@ class vector {
             return *this;
         }
 
-        Alloc new_alloc = std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value ? other.alloc_ : alloc_;
+        if constexpr (std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value) {
+            // Наш буфер выделен старым аллокатором - ему его и вернуть, прежде чем перенимать аллокатор other
+            if (alloc_ != other.alloc_) {
+                clear();
+                std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+                arr_ = nullptr;
+                cap_ = 0;
+            }
+            alloc_ = other.alloc_;
+        }
 
-        if (alloc_ == other.alloc_ && (std::is_nothrow_copy_assignable<T>::value || noexcept(T(std::declval<const T&>())))) {
-            if (cap_ >= other.cap_) {
-                if (sz_ >= other.sz_) {
-                    for (size_type i = 0; i < other.sz_; ++i) {
-                        arr_[i] = other.arr_[i];
-                    }
-                    for (size_type i = other.sz_; i < sz_; ++i) {
-                        std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                    }
-                } else {
-                    for (size_type i = 0; i < sz_; ++i) {
-                        arr_[i] = other.arr_[i];
-                    }
-                    for (size_type i = sz_; i < other.sz_; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, other.arr_[i]);
-                    }
-                }
+        // Переиспользовать буфер можно, только если копирование не бросает: иначе вектор остался бы наполовину присвоенным
+        constexpr bool nothrow_copy = std::is_nothrow_copy_assignable_v<T> && std::is_nothrow_copy_constructible_v<T>;
+
+        if (nothrow_copy && cap_ >= other.sz_) {
+            size_type common = std::min(sz_, other.sz_);
+            assign_range(arr_, std::to_address(other.arr_), common);
+            if (sz_ > other.sz_) {
+                destroy_tail(other.sz_);
             } else {
-                for (size_type i = 0; i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                }
-                reserve(other.cap_);
-                for (size_type i = 0; i < other.sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, other.arr_[i]);
-                }
+                construct_range(arr_ + sz_, std::to_address(other.arr_) + sz_, other.sz_ - sz_);
             }
             sz_ = other.sz_;
-
         } else {
-            T* new_arr = std::allocator_traits<Alloc>::allocate(new_alloc, other.cap_);
-            
-            size_type i = 0;
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, other.sz_);
             try {
-                for (; i < other.sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(new_alloc, new_arr + i, other[i]);
-                }
+                construct_range(new_arr, std::to_address(other.arr_), other.sz_);
             } catch (...) {
-                for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(new_alloc, new_arr + j);
-                }
-                std::allocator_traits<Alloc>::deallocate(new_alloc, new_arr, other.cap_);
+                std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, other.sz_);
                 throw;
             }
 
-            for (size_type k = 0; k < sz_; ++k) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + k);
-            }
+            clear();
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+            trace_allocate(other.sz_);
 
-            alloc_ = new_alloc;
             arr_ = new_arr;
             sz_ = other.sz_;
-            cap_ = other.cap_; 
+            cap_ = other.sz_;
         }
         return *this;
     }
@@ -356,7 +369,7 @@ class vector {
             }
             
             for (size_type i = 0; i < other.sz_; ++i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, std::move(other.arr_[i]));
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), std::move(other.arr_[i]));
             }
             sz_ = other.sz_;
             
@@ -364,7 +377,7 @@ class vector {
         }
         else {
             for (size_type i = 0; i < sz_; ++i) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
             
@@ -385,49 +398,22 @@ class vector {
     }
 
     vector& operator=(std::initializer_list<value_type> ilist) {
-        typename std::initializer_list<value_type>::iterator it = ilist.begin();
-        if (cap_ > ilist.size()) {
-            if (sz_ >= ilist.size()) {
-                for (size_type i = 0; i < ilist.size(); ++i) {
-                    arr_[i] = *it;
-                    ++it;
-                }
-
-                for (size_type i = ilist.size(); i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
-                }
-            } else {
-                clear();
-                for (size_type i = 0; i < ilist.size(); ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *it);
-                    ++it;
-                }
-            }
-        } else {
-            vector tmp;
-            tmp.reserve(ilist.size());
-            for (const auto& item : ilist) {
-                tmp.push_back(item);
-            }
-            swap(*this, tmp);
-        }
-        sz_ = ilist.size();
+        assign(ilist.begin(), ilist.end());
         return *this;
     }
 
 
-
     // Element access
     constexpr reference at(size_type n) {
         if (n >= size()) {
-            throw std::out_of_range();
+            throw std::out_of_range("vector::at");
         }
         return arr_[n];
     }
 
     constexpr const_reference at(size_type n) const {
         if (n >= size()) {
-            throw std::out_of_range();
+            throw std::out_of_range("vector::at");
         }
         return arr_[n];
     }
@@ -456,12 +442,12 @@ class vector {
         return arr_[sz_ - 1];
     }
 
-    constexpr pointer data() noexcept {
-        return sz_ == 0 ? nullptr : arr_;;
+    constexpr T* data() noexcept {
+        return sz_ == 0 ? nullptr : std::to_address(arr_);
     }
 
-    constexpr const_pointer data() const noexcept {
-        return sz_ == 0 ? nullptr : arr_;;
+    constexpr const T* data() const noexcept {
+        return sz_ == 0 ? nullptr : std::to_address(arr_);
     }
 
 
@@ -536,35 +522,37 @@ class vector {
         }
 
         if (new_cap > max_size()) {
-            throw std::length_error();
+            throw std::length_error("vector::reserve");
         }
 
-        T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+        pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
         size_type i = 0;
         try {
             for (; i < sz_; ++i) {
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
             }
         } catch (...) {
             for (size_type j = 0; j < i; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j  );
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j  ));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
             throw;
         }
 
         for (size_type k = 0; k < sz_; ++k) {
-            std::allocator_traits<Alloc>::destroy(alloc_, arr_ + k);
+            std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + k));
         }
         std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+        trace_reallocate(new_cap, sz_);
         arr_ = new_arr;
         cap_ = new_cap;
     }
     
     constexpr void shrink_to_fit() {
         if (sz_ == 0) {
+            trace_shrink_to_fit(0);
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
             arr_ = nullptr;
             cap_ = 0;
@@ -575,26 +563,27 @@ class vector {
             return;
         }
 
-        T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, sz_);
+        pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, sz_);
 
         size_type i = 0;
         try {
             for (; i < sz_; ++i) {
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
             }
         } catch (...) {
             for (size_type j = 0; j < i; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, sz_);
             throw;
         }
 
         for (size_type j = 0; j < sz_; ++j) {
-            std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+            std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
         }
         std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+        trace_shrink_to_fit(sz_);
         arr_ = new_arr;
         cap_ = sz_;
     }
@@ -608,7 +597,7 @@ class vector {
     // Modifiers
     constexpr void clear() noexcept {
         for (size_type i = 0; i < sz_; ++i) {
-            std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+            std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
         }
         sz_ = 0;
     }
@@ -617,8 +606,8 @@ class vector {
         size_type index = pos - cbegin();
 
         std::optional<value_type> copy_val;
-        const_pointer val_ptr = std::addressof(value);
-        bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, arr_ + sz_) && std::greater_equal<const T*>()(val_ptr, arr_));
+        const T* val_ptr = std::addressof(value);
+        bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, std::to_address(arr_) + sz_) && std::greater_equal<const T*>()(val_ptr, std::to_address(arr_)));
         if (value_inside_vector) {
             copy_val.emplace(value);
             val_ptr = std::addressof(*copy_val);
@@ -626,39 +615,41 @@ class vector {
 
         if (sz_ == cap_) {
             size_type new_cap = cap_ != 0 ? cap_ * 2 : 1;
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < index; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + index, *val_ptr);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + index), *val_ptr);
                 ++i;
                 for (; i <= sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - 1]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - 1]));
                 }
             } catch (...)   {
                  for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type j = 0; j < sz_; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
             for (size_type i = sz_; i > index; --i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, std::move_if_noexcept(arr_[i - 1]));
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i - 1);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), std::move_if_noexcept(arr_[i - 1]));
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i - 1));
             }
-            std::allocator_traits<Alloc>::construct(alloc_, arr_ + index, *val_ptr);
+            std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + index), *val_ptr);
+            trace_shift(sz_ - index);
         }
         ++sz_;
         return iterator(arr_ + index);
@@ -669,39 +660,41 @@ class vector {
         T tmp = std::move(value);
         if (sz_ == cap_) {
             size_type new_cap = cap_ != 0 ? cap_ * 2 : 1;
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < index; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + index, std::move(tmp));
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + index), std::move(tmp));
                 ++i;
                 for (; i <= sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - 1]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - 1]));
                 }
             } catch (...)   {
                  for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type j = 0; j < sz_; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
             for (size_type i = sz_; i > index; --i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, std::move_if_noexcept(arr_[i - 1]));
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i - 1);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), std::move_if_noexcept(arr_[i - 1]));
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i - 1));
             }
-            std::allocator_traits<Alloc>::construct(alloc_, arr_ + index, std::move(tmp));
+            std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + index), std::move(tmp));
+            trace_shift(sz_ - index);
         }
         ++sz_;
         return iterator(arr_ + index);
@@ -711,8 +704,8 @@ class vector {
         size_type index = pos - cbegin();
 
         std::optional<value_type> copy_val;
-        const_pointer val_ptr = std::addressof(value);
-        bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, arr_ + sz_) && std::greater_equal<const T*>()(val_ptr, arr_));
+        const T* val_ptr = std::addressof(value);
+        bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, std::to_address(arr_) + sz_) && std::greater_equal<const T*>()(val_ptr, std::to_address(arr_)));
         if (value_inside_vector) {
             copy_val.emplace(value);
             val_ptr = std::addressof(*copy_val);
@@ -724,45 +717,47 @@ class vector {
             if (sz_ + count > new_cap) {
                 new_cap = sz_ + count;
             }
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < index; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
 
                 for (; i < index + count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, *val_ptr);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), *val_ptr);
                 }
                 
                 for (; i < sz_ + count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - count]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - count]));
                 }
             } catch (...)   {
                  for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type j = 0; j < sz_; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
             for (size_type i = sz_; i-- > index;) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i + count, std::move_if_noexcept(arr_[i]));
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i + count), std::move_if_noexcept(arr_[i]));
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
             }
 
             for (size_type i = index; i < index + count; ++i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *val_ptr);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), *val_ptr);
             }
+            trace_shift(sz_ - index);
         }
         sz_ += count;
         return iterator(arr_ + index);
@@ -781,8 +776,8 @@ class vector {
             size_type count = std::distance(first, last);
 
             std::optional<vector<value_type>> copy_range;
-            const_pointer val_ptr = std::addressof(*first);
-            bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, arr_ + sz_) && std::greater_equal<const T*>()(val_ptr, arr_));
+            const T* val_ptr = std::addressof(*first);
+            bool value_inside_vector = arr_ && (std::less<const T*>()(val_ptr, std::to_address(arr_) + sz_) && std::greater_equal<const T*>()(val_ptr, std::to_address(arr_)));
             if (value_inside_vector) {
                 copy_range.emplace();
                 for (InputIt it = first; it != last; ++it) {
@@ -796,47 +791,49 @@ class vector {
                 if (sz_ + count > new_cap) {
                     new_cap = sz_ + count;
                 }
-                T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+                pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
                 size_type i = 0;
                 try {
                     for (; i < index; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                        std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                     }
 
                     for (; i < index + count; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, *val_ptr);
+                        std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), *val_ptr);
                         ++val_ptr;
                     }
                     
                     for (; i < sz_ + count; ++i) {
-                        std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - count]));
+                        std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - count]));
                     }
                 } catch (...)   {
                     for (size_type j = 0; j < i; ++j) {
-                        std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                        std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                     }
                     std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                     throw;
                 }
 
                 for (size_type j = 0; j < sz_; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+                trace_reallocate(new_cap, sz_);
                 arr_ = new_arr;
                 cap_ = new_cap;
             } else {
                 for (size_type i = sz_; i-- > index;) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i + count, std::move_if_noexcept(arr_[i]));
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i + count), std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
                 }
 
                 for (size_type i = index; i < index + count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *val_ptr);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), *val_ptr);
                     ++val_ptr;
                 }
+                trace_shift(sz_ - index);
             }
             sz_ += count;
         } else {
@@ -864,47 +861,49 @@ class vector {
             if (sz_ + count > new_cap) {
                 new_cap = sz_ + count;
             }
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < index; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
 
                 for (; i < index + count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, *it);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), *it);
                     ++it;
                 }
                 
                 for (; i < sz_ + count; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - count]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - count]));
                 }
             } catch (...)   {
                  for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type j = 0; j < sz_; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
             for (size_type i = sz_; i-- > index;) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i + count, std::move_if_noexcept(arr_[i]));
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i + count), std::move_if_noexcept(arr_[i]));
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
             }
 
             for (size_type i = index; i < index + count; ++i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, *it);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), *it);
                 ++it;
             }
+            trace_shift(sz_ - index);
         }
         sz_ += count;
         return iterator(arr_ + index);
@@ -923,73 +922,199 @@ class vector {
         if (sz_ == cap_) {
             size_type new_cap = cap_ != 0 ? cap_ * 2 : 1;
 
-            T*  new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
             size_type i = 0;
             try {
                 for (; i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + sz_, std::forward<Args>(args)...);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + sz_), std::forward<Args>(args)...);
                 ++i;
             } catch (...) {
                 for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type k = 0; k < sz_; ++k) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + k);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + k));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
-            std::allocator_traits<Alloc>::construct(alloc_, arr_ + sz_, std::forward<Args>(args)...);
+            std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + sz_), std::forward<Args>(args)...);
         }
         ++sz_;
         return arr_[sz_ - 1];
     }
 
+    /*
+        Добавление диапазона в конец. Для forward-итераторов размер известен заранее, поэтому память выделяется не больше
+        одного раза, а не log(n) раз, как при push_back в цикле. Если источник непрерывный, T тривиально копируемый и аллокатор
+        не переопределяет construct, элементы копируются одним memcpy.
+
+        Новые элементы конструируются раньше, чем переносятся старые, поэтому источником может быть и сам вектор.
+    */
+    template <typename InputIt>
+    requires (!std::is_integral_v<InputIt>)
+    constexpr void append(InputIt first, InputIt last) {
+        if constexpr (std::derived_from<typename std::iterator_traits<InputIt>::iterator_category, std::forward_iterator_tag>) {
+            size_type count = std::distance(first, last);
+            if (count == 0) {
+                return;
+            }
+
+            if (sz_ + count > cap_) {
+                if (sz_ + count > max_size()) {
+                    throw std::length_error("vector::append");
+                }
+                size_type new_cap = cap_ * 2 > sz_ + count ? cap_ * 2 : sz_ + count;
+                pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+
+                try {
+                    construct_range(new_arr + sz_, first, count);
+                } catch (...) {
+                    std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
+                    throw;
+                }
+
+                size_type i = 0;
+                try {
+                    for (; i < sz_; ++i) {
+                        std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
+                    }
+                } catch (...) {
+                    for (size_type j = 0; j < i; ++j) {
+                        std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
+                    }
+                    for (size_type j = sz_; j < sz_ + count; ++j) {
+                        std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
+                    }
+                    std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
+                    throw;
+                }
+
+                for (size_type k = 0; k < sz_; ++k) {
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + k));
+                }
+                std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+                trace_reallocate(new_cap, sz_);
+                arr_ = new_arr;
+                cap_ = new_cap;
+            } else {
+                construct_range(arr_ + sz_, first, count);
+            }
+            sz_ += count;
+        } else {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+    }
+
+    template <std::ranges::input_range R>
+    constexpr void append_range(R&& range) {
+        if constexpr (std::ranges::common_range<R>) {
+            append(std::ranges::begin(range), std::ranges::end(range));
+        } else if constexpr (std::ranges::sized_range<R>) {
+            auto common = std::views::common(std::views::counted(std::ranges::begin(range), std::ranges::size(range)));
+            append(common.begin(), common.end());
+        } else {
+            for (auto&& item : range) {
+                emplace_back(std::forward<decltype(item)>(item));
+            }
+        }
+    }
+
+    /*
+        Пакетная вставка: [first, last) - пары (позиция, значение), позиции - номера в векторе до вставки, по неубыванию;
+        позиция size() означает конец. Значения с одинаковой позицией встают перед старым элементом в порядке следования.
+        В отличие от insert в цикле (O(n * k) сдвигов и, возможно, несколько перевыделений) память выделяется не больше
+        одного раза, а каждый элемент сдвигается ровно один раз: вектор заполняется с конца, сразу на итоговые места.
+    */
+    template <typename BidirIt>
+    requires std::bidirectional_iterator<BidirIt>
+    constexpr void insert_batch(BidirIt first, BidirIt last) {
+        size_type prev = 0;
+        for (BidirIt it = first; it != last; ++it) {
+            size_type pos = static_cast<size_type>(std::get<0>(*it));
+            if (pos > sz_) {
+                throw std::out_of_range("vector::insert_batch");
+            }
+            if (pos < prev) {
+                throw std::invalid_argument("vector::insert_batch: positions are not sorted");
+            }
+            prev = pos;
+        }
+
+        // Если *it - временный объект, ссылка на его поле пережила бы его, поэтому значение забирается по значению
+        merge_from_back(first, last,
+                        [](const auto& item, size_type old_index) { return static_cast<size_type>(std::get<0>(item)) <= old_index; },
+                        [](BidirIt it) -> decltype(auto) {
+                            if constexpr (std::is_reference_v<std::iter_reference_t<BidirIt>>) {
+                                return std::get<1>(*it);
+                            } else {
+                                return std::tuple_element_t<1, std::iter_value_t<BidirIt>>(std::get<1>(*it));
+                            }
+                        });
+    }
+
+    /*
+        Слияние отсортированного диапазона в отсортированный вектор с тем же упорядочением comp, за O(n + k) и не больше
+        одного выделения памяти. Устойчиво: из равных элементов старые остаются впереди новых.
+    */
+    template <typename BidirIt, typename Compare = std::less<>>
+    requires std::bidirectional_iterator<BidirIt>
+    constexpr void merge_sorted(BidirIt first, BidirIt last, Compare comp = Compare()) {
+        merge_from_back(first, last,
+                        [this, &comp](const auto& item, size_type old_index) { return comp(item, arr_[old_index]); },
+                        [](BidirIt it) -> decltype(auto) { return *it; });
+    }
+
     template <typename... Args>
     constexpr iterator emplace(const_iterator pos, Args&&... args) {
         size_type index = pos - cbegin();
         if (sz_ == cap_) {
             size_type new_cap = cap_ != 0 ? cap_ * 2 : 1;
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < index; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
-                std::allocator_traits<Alloc>::construct(alloc_, new_arr + index, std::forward<Args>(args)...);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + index), std::forward<Args>(args)...);
                 ++i;
                 for (; i <= sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i - 1]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i - 1]));
                 }
             } catch (...)   {
                  for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
                 throw;
             }
 
             for (size_type j = 0; j < sz_; ++j) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
 
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         } else {
             for (size_type i = sz_; i > index; --i) {
-                std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, std::move_if_noexcept(arr_[i - 1]));
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i - 1);
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), std::move_if_noexcept(arr_[i - 1]));
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i - 1));
             }
-            std::allocator_traits<Alloc>::construct(alloc_, arr_ + index, std::forward<Args>(args)...);
+            std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + index), std::forward<Args>(args)...);
+            trace_shift(sz_ - index);
         }
         ++sz_;
         return iterator(arr_ + index);
@@ -997,24 +1122,24 @@ class vector {
 
     constexpr void pop_back() {
         --sz_;
-        std::allocator_traits<Alloc>::destroy(alloc_, arr_ + sz_);
+        std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + sz_));
         return;
     }
 
     constexpr void resize(size_type n, const T& value = T()) {
         if (n < sz_) {
             for (size_type i = n; i < sz_; ++i) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + i);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
             }
         } else if (n <= cap_) {
             size_type i = sz_;
             try {
                 for (; i < n; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, arr_ + i, value);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + i), value);
                 }
             } catch (...) {
                 for (size_type j = sz_; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, arr_ + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + j));
                 }
                 throw;
             }
@@ -1023,20 +1148,20 @@ class vector {
             if (new_cap < n) {
                 new_cap = n;
             }
-            T* new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+            pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
 
             size_type i = 0;
             try {
                 for (; i < sz_; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, std::move_if_noexcept(arr_[i]));
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), std::move_if_noexcept(arr_[i]));
                 }
 
                 for (; i < n; ++i) {
-                    std::allocator_traits<Alloc>::construct(alloc_, new_arr + i, value);
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + i), value);
                 }
             } catch (...) {
                 for (size_type j = 0; j < i; ++j) {
-                    std::allocator_traits<Alloc>::destroy(alloc_, new_arr + j);
+                    std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
                 }
 
                 std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
@@ -1044,9 +1169,10 @@ class vector {
             }
 
             for (size_type k = 0; k < sz_; ++k) {
-                std::allocator_traits<Alloc>::destroy(alloc_, arr_ + k);
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + k));
             }
             std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+            trace_reallocate(new_cap, sz_);
             arr_ = new_arr;
             cap_ = new_cap;
         }
@@ -1055,17 +1181,19 @@ class vector {
     }
 
     constexpr iterator erase(iterator pos) {
-        pointer p = std::to_address(pos);
-        pointer new_end = std::move(p + 1, arr_ + sz_, p);
+        T* p = std::to_address(pos);
+        T* new_end = std::move(p + 1, std::to_address(arr_) + sz_, p);
+        trace_shift(static_cast<size_type>(new_end - p));
         std::allocator_traits<Alloc>::destroy(alloc_, new_end);
         --sz_;
-        return iterator(p);
+        return pos;
     }
 
     constexpr iterator erase(const_iterator pos) {
         iterator mutable_pos = begin() + (pos - cbegin());
-        pointer p = std::to_address(mutable_pos);
-        pointer new_end = std::move(p + 1, arr_ + sz_, p);
+        T* p = std::to_address(mutable_pos);
+        T* new_end = std::move(p + 1, std::to_address(arr_) + sz_, p);
+        trace_shift(static_cast<size_type>(new_end - p));
         std::allocator_traits<Alloc>::destroy(alloc_, new_end);
         --sz_;
         return mutable_pos;
@@ -1076,13 +1204,14 @@ class vector {
             return first;
         }
 
-        pointer p_first = std::to_address(first);
-        pointer p_last = std::to_address(last);
+        T* p_first = std::to_address(first);
+        T* p_last = std::to_address(last);
         size_type count = p_last - p_first;
 
-        pointer new_end = std::move(p_last, arr_ + sz_, p_first);
+        T* new_end = std::move(p_last, std::to_address(arr_) + sz_, p_first);
+        trace_shift(static_cast<size_type>(new_end - p_first));
 
-        for (pointer p = new_end; p != arr_ + sz_; ++p) {
+        for (T* p = new_end; p != std::to_address(arr_) + sz_; ++p) {
             std::allocator_traits<Alloc>::destroy(alloc_, p);
         }
         sz_ -= count;
@@ -1097,19 +1226,39 @@ class vector {
             return mutable_first;
         }
 
-        pointer p_first = std::to_address(mutable_first);
-        pointer p_last = std::to_address(mutable_last);
+        T* p_first = std::to_address(mutable_first);
+        T* p_last = std::to_address(mutable_last);
         size_type count = p_last - p_first;
 
-        pointer new_end = std::move(p_last, arr_ + sz_, p_first);
+        T* new_end = std::move(p_last, std::to_address(arr_) + sz_, p_first);
+        trace_shift(static_cast<size_type>(new_end - p_first));
 
-        for (pointer p = new_end; p != arr_ + sz_; ++p) {
+        for (T* p = new_end; p != std::to_address(arr_) + sz_; ++p) {
             std::allocator_traits<Alloc>::destroy(alloc_, p);
         }
         sz_ -= count;
         return mutable_first;
     }
 
+    // Удаление за O(1) без сохранения порядка: на место pos переезжает последний элемент
+    constexpr iterator swap_remove(const_iterator pos) {
+        iterator mutable_pos = begin() + (pos - cbegin());
+        T* p = std::to_address(mutable_pos);
+        T* last = std::to_address(arr_) + sz_ - 1;
+        if (p != last) {
+            *p = std::move(*last);
+            trace_shift(1);
+        }
+        std::allocator_traits<Alloc>::destroy(alloc_, last);
+        --sz_;
+        return mutable_pos;
+    }
+
+    // Для свободных алгоритмов, которые сами передвигают элементы внутри вектора (erase_if, erase_indices)
+    constexpr void note_shift(size_type count) noexcept {
+        trace_shift(count);
+    }
+
     void swap(vector& other) noexcept(std::allocator_traits<Alloc>::propagate_on_container_swap::value || std::allocator_traits<Alloc>::is_always_equal::value) {
         std::swap(arr_, other.arr_);        
         std::swap(sz_, other.sz_);
@@ -1122,4 +1271,232 @@ class vector {
         }
     }
 
-};
\ No newline at end of file
+
+
+    private:
+
+    // Можно ли копировать элементы из ForwardIt в буфер побайтово
+    template <typename ForwardIt>
+    static constexpr bool bulk_copyable =
+        std::contiguous_iterator<ForwardIt> &&
+        std::is_same_v<std::remove_cv_t<std::iter_value_t<ForwardIt>>, T> &&
+        std::is_trivially_copyable_v<T> &&
+        has_trivial_construct<Alloc>::value;
+
+    // Конструирует count элементов из [first, ...) в неинициализированной памяти dst; при исключении откатывает созданное
+    template <typename ForwardIt>
+    constexpr void construct_range(pointer dst, ForwardIt first, size_type count) {
+        if constexpr (bulk_copyable<ForwardIt>) {
+            if (!std::is_constant_evaluated()) {
+                if (count != 0) {
+                    vector_copy_bytes(std::to_address(dst), std::to_address(first), count * sizeof(T));
+                }
+                return;
+            }
+        }
+
+        size_type i = 0;
+        try {
+            for (; i < count; ++i, ++first) {
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(dst + i), *first);
+            }
+        } catch (...) {
+            for (size_type j = 0; j < i; ++j) {
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(dst + j));
+            }
+            throw;
+        }
+    }
+
+    // Заполнение тривиально копируемыми значениями: construct аллокатора ничего не добавляет, можно писать байты напрямую
+    static constexpr bool bulk_fillable = std::is_trivially_copyable_v<T> && has_trivial_construct<Alloc>::value;
+
+    // Конструирует count копий value в неинициализированной памяти dst; при исключении откатывает созданное
+    constexpr void construct_fill(pointer dst, size_type count, const T& value) {
+        if constexpr (bulk_fillable) {
+            if (!std::is_constant_evaluated()) {
+                vector_fill_bytes(std::to_address(dst), count, value);
+                return;
+            }
+        }
+
+        size_type i = 0;
+        try {
+            for (; i < count; ++i) {
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(dst + i), value);
+            }
+        } catch (...) {
+            for (size_type j = 0; j < i; ++j) {
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(dst + j));
+            }
+            throw;
+        }
+    }
+
+    // То же для value-initialization: для тривиальных типов это копии T{}, чаще всего - один memset нулями
+    constexpr void construct_default(pointer dst, size_type count) {
+        if constexpr (bulk_fillable && std::is_trivially_default_constructible_v<T>) {
+            if (!std::is_constant_evaluated()) {
+                vector_fill_bytes(std::to_address(dst), count, T());
+                return;
+            }
+        }
+
+        size_type i = 0;
+        try {
+            for (; i < count; ++i) {
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(dst + i));
+            }
+        } catch (...) {
+            for (size_type j = 0; j < i; ++j) {
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(dst + j));
+            }
+            throw;
+        }
+    }
+
+    // Присваивает count элементов из [first, ...) уже живым объектам dst; возвращает итератор за последним прочитанным
+    template <typename ForwardIt>
+    constexpr ForwardIt assign_range(pointer dst, ForwardIt first, size_type count) {
+        if constexpr (std::contiguous_iterator<ForwardIt> &&
+                      std::is_same_v<std::remove_cv_t<std::iter_value_t<ForwardIt>>, T> &&
+                      std::is_trivially_copyable_v<T>) {
+            if (!std::is_constant_evaluated()) {
+                if (count != 0) {
+                    vector_copy_bytes(std::to_address(dst), std::to_address(first), count * sizeof(T));
+                }
+                return std::next(first, static_cast<std::iter_difference_t<ForwardIt>>(count));
+            }
+        }
+
+        for (size_type i = 0; i < count; ++i, ++first) {
+            dst[i] = *first;
+        }
+        return first;
+    }
+
+    /*
+        Общая часть insert_batch и merge_sorted: слияние старых элементов с новыми [first, last). before(item, i) - должен ли
+        новый элемент стоять раньше старого arr_[i], value(it) - то, из чего конструируется новый элемент.
+
+        Если места хватает и перемещения не бросают, вектор заполняется с конца на месте: старый элемент или новое значение
+        сразу записываются на итоговую позицию (в неинициализированный хвост - конструированием, в живые элементы -
+        присваиванием). Иначе строится новый буфер слева направо, как в reserve, и исходный вектор при исключении не меняется.
+    */
+    template <typename BidirIt, typename Before, typename Value>
+    constexpr void merge_from_back(BidirIt first, BidirIt last, Before before, Value value) {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0) {
+            return;
+        }
+        if (sz_ + count > max_size()) {
+            throw std::length_error("vector::insert_batch");
+        }
+        size_type new_size = sz_ + count;
+
+        using value_source = decltype(value(first));
+        constexpr bool nothrow_in_place = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T> &&
+                                          std::is_nothrow_constructible_v<T, value_source> &&
+                                          std::is_nothrow_assignable_v<T&, value_source>;
+
+        if (new_size <= cap_ && nothrow_in_place) {
+            auto place = [this](size_type index, auto&& x) {
+                if (index >= sz_) {
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(arr_ + index), std::forward<decltype(x)>(x));
+                } else {
+                    arr_[index] = std::forward<decltype(x)>(x);
+                }
+            };
+
+            size_type dst = new_size;
+            size_type src = sz_;
+            BidirIt it = last;
+            while (it != first) {
+                --it;
+                while (src > 0 && before(*it, src - 1)) {
+                    --src;
+                    --dst;
+                    place(dst, std::move(arr_[src]));
+                }
+                --dst;
+                place(dst, value(it));
+            }
+            trace_shift(sz_ - src);
+            sz_ = new_size;
+            return;
+        }
+
+        size_type new_cap = new_size <= cap_ ? cap_ : (cap_ * 2 > new_size ? cap_ * 2 : new_size);
+        pointer new_arr = std::allocator_traits<Alloc>::allocate(alloc_, new_cap);
+
+        size_type built = 0;
+        size_type src = 0;
+        try {
+            for (BidirIt it = first; it != last; ++it) {
+                while (src < sz_ && !before(*it, src)) {
+                    std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + built), std::move_if_noexcept(arr_[src]));
+                    ++built;
+                    ++src;
+                }
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + built), value(it));
+                ++built;
+            }
+            for (; src < sz_; ++src) {
+                std::allocator_traits<Alloc>::construct(alloc_, std::to_address(new_arr + built), std::move_if_noexcept(arr_[src]));
+                ++built;
+            }
+        } catch (...) {
+            for (size_type j = 0; j < built; ++j) {
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(new_arr + j));
+            }
+            std::allocator_traits<Alloc>::deallocate(alloc_, new_arr, new_cap);
+            throw;
+        }
+
+        trace_reallocate(new_cap, sz_);
+        clear();
+        std::allocator_traits<Alloc>::deallocate(alloc_, arr_, cap_);
+        arr_ = new_arr;
+        cap_ = new_cap;
+        sz_ = new_size;
+    }
+
+    // Сообщения политике наблюдения; cap_ в момент вызова - ещё старая ёмкость
+    constexpr void trace_allocate(size_type new_cap) noexcept {
+        if (!std::is_constant_evaluated()) {
+            Instrumentation::template on_allocate<T>(new_cap);
+        }
+    }
+
+    // Рост из пустого буфера - это не перенос, а первое выделение
+    constexpr void trace_reallocate(size_type new_cap, size_type moved) noexcept {
+        if (!std::is_constant_evaluated()) {
+            if (cap_ == 0) {
+                Instrumentation::template on_allocate<T>(new_cap);
+            } else {
+                Instrumentation::template on_reallocate<T>(cap_, new_cap, moved);
+            }
+        }
+    }
+
+    constexpr void trace_shift(size_type count) noexcept {
+        if (!std::is_constant_evaluated() && count != 0) {
+            Instrumentation::template on_shift<T>(count);
+        }
+    }
+
+    constexpr void trace_shrink_to_fit(size_type new_cap) noexcept {
+        if (!std::is_constant_evaluated() && cap_ != new_cap) {
+            Instrumentation::template on_shrink_to_fit<T>(cap_, new_cap, sz_ < new_cap ? sz_ : new_cap);
+        }
+    }
+
+    // Разрушает элементы [new_size, sz_); sz_ не меняет
+    constexpr void destroy_tail(size_type new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_type i = new_size; i < sz_; ++i) {
+                std::allocator_traits<Alloc>::destroy(alloc_, std::to_address(arr_ + i));
+            }
+        }
+    }
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include <iostream>
+#include <cstring>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector.h"
+
+
+/*
+    Массовое удаление и вставка в vector за один проход.
+
+    Вызов erase(pos) в цикле сдвигает хвост на каждом удалении - O(n * k). Здесь оставшиеся элементы уплотняются одним
+    проходом слева направо, а освободившийся хвост разрушается одним erase(new_end, end()), который уже ничего не сдвигает.
+
+    erase_if(v, pred) - удаляет все элементы, для которых pred истинен. Для тривиально копируемых типов уплотнение
+    безветвленное: каждый элемент записывается на позицию записи, а позиция продвигается на !pred(x). Результат предиката
+    не участвует в переходах, поэтому непредсказуемый фильтр (истечение записей кэша) не срывает конвейер.
+
+    erase_indices(v, indices) - удаляет элементы с заданными номерами; номера отсортированы по возрастанию (повторы
+    допускаются). Отрезки между удаляемыми позициями переносятся целиком - для тривиальных типов одним memmove.
+
+    insert_batch / merge_sorted_into - обратная операция: k вставок за O(n + k) с одним выделением памяти (см. vector::insert_batch).
+*/
+
+
+// Возвращает число удалённых элементов
+template <typename T, typename Alloc, typename Instrumentation, typename Predicate>
+typename vector<T, Alloc, Instrumentation>::size_type erase_if(vector<T, Alloc, Instrumentation>& v, Predicate pred) {
+    T* data = v.data();
+    std::size_t n = v.size();
+
+    std::size_t read = 0;
+    // Пока ничего не удалено, перемещать нечего
+    while (read < n && !pred(std::as_const(data[read]))) {
+        ++read;
+    }
+    std::size_t first_removed = read;
+    std::size_t write = read;
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        for (; read < n; ++read) {
+            T value = data[read];
+            data[write] = value;
+            write += !static_cast<bool>(pred(std::as_const(value)));
+        }
+    } else {
+        for (; read < n; ++read) {
+            if (!pred(std::as_const(data[read]))) {
+                data[write] = std::move(data[read]);
+                ++write;
+            }
+        }
+    }
+
+    v.note_shift(write - first_removed);
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(write), v.end());
+    return n - write;
+}
+
+// Удаляет все элементы, равные value
+template <typename T, typename Alloc, typename Instrumentation, typename U>
+typename vector<T, Alloc, Instrumentation>::size_type erase(vector<T, Alloc, Instrumentation>& v, const U& value) {
+    return erase_if(v, [&value](const T& x) { return x == value; });
+}
+
+
+// Номера должны идти по возрастанию и быть меньше v.size(); проверяется до изменения вектора. Возвращает число удалённых
+template <typename T, typename Alloc, typename Instrumentation>
+typename vector<T, Alloc, Instrumentation>::size_type erase_indices(vector<T, Alloc, Instrumentation>& v, std::span<const std::size_t> indices) {
+    std::size_t n = v.size();
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= n) {
+            throw std::out_of_range("erase_indices: index out of range");
+        }
+        if (i > 0 && indices[i] < indices[i - 1]) {
+            throw std::invalid_argument("erase_indices: indices are not sorted");
+        }
+    }
+    if (indices.empty()) {
+        return 0;
+    }
+
+    T* data = v.data();
+    std::size_t write = indices[0];
+    std::size_t i = 0;
+    while (i < indices.size()) {
+        std::size_t removed = indices[i];
+        // Повторы одного номера удаляют элемент один раз
+        while (i < indices.size() && indices[i] == removed) {
+            ++i;
+        }
+        std::size_t run_begin = removed + 1;
+        std::size_t run_end = i < indices.size() ? indices[i] : n;
+
+        std::size_t run = run_end - run_begin;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (run != 0) {
+                std::memmove(data + write, data + run_begin, run * sizeof(T));
+            }
+        } else {
+            std::move(data + run_begin, data + run_end, data + write);
+        }
+        write += run;
+    }
+
+    v.note_shift(write - indices[0]);
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(write), v.end());
+    return n - write;
+}
+
+template <typename T, typename Alloc, typename Instrumentation>
+typename vector<T, Alloc, Instrumentation>::size_type erase_indices(vector<T, Alloc, Instrumentation>& v, std::initializer_list<std::size_t> indices) {
+    return erase_indices(v, std::span<const std::size_t>(indices.begin(), indices.size()));
+}
+
+
+
+/*
+    Свободные обёртки над vector::insert_batch и vector::merge_sorted для произвольных диапазонов. Если диапазон не
+    двунаправленный (например, однопроходный view), он сначала копируется во временный вектор. Для insert_batch то же
+    делается с диапазоном, который отдаёт пары по значению (views::transform): каждый проход строил бы их заново.
+*/
+// Элементы буфера как rvalue-ссылки. std::move_iterator в C++20 - только input_iterator, а insert_batch нужен двунаправленный
+template <typename Items>
+auto as_rvalues(Items& items) {
+    return items | std::views::transform([](auto& item) -> decltype(auto) { return std::move(item); });
+}
+
+template <typename T, typename Alloc, typename Instrumentation, std::ranges::input_range R>
+void insert_batch(vector<T, Alloc, Instrumentation>& v, R&& positioned_values) {
+    if constexpr (std::ranges::bidirectional_range<R> && std::ranges::common_range<R> &&
+                  std::is_reference_v<std::ranges::range_reference_t<R>>) {
+        v.insert_batch(std::ranges::begin(positioned_values), std::ranges::end(positioned_values));
+    } else {
+        vector<std::ranges::range_value_t<R>> items;
+        items.append_range(std::forward<R>(positioned_values));
+        auto moved = as_rvalues(items);
+        v.insert_batch(moved.begin(), moved.end());
+    }
+}
+
+template <typename T, typename Alloc, typename Instrumentation, std::ranges::input_range R, typename Compare = std::less<>>
+void merge_sorted_into(vector<T, Alloc, Instrumentation>& v, R&& sorted_range, Compare comp = Compare()) {
+    if constexpr (std::ranges::bidirectional_range<R> && std::ranges::common_range<R>) {
+        v.merge_sorted(std::ranges::begin(sorted_range), std::ranges::end(sorted_range), std::move(comp));
+    } else {
+        vector<std::ranges::range_value_t<R>> items;
+        items.append_range(std::forward<R>(sorted_range));
+        auto moved = as_rvalues(items);
+        v.merge_sorted(moved.begin(), moved.end(), std::move(comp));
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#include "vector.h"
+
+
+/*
+    Считающая политика наблюдения для vector (см. vector_no_instrumentation в vector.h).
+
+    vector_counting_instrumentation<Tag> складывает события в счётчики, отдельные для каждой пары (тип элемента, Tag).
+    Tag - любой тип-метка, которым помечают интересующие вектора: например, struct order_book_tag {}; у метки может быть
+    static constexpr const char* name, иначе в отчёте будет имя типа. Счётчики - relaxed-атомики, поэтому политику можно
+    использовать в нескольких потоках; стоимость события - несколько атомарных сложений, выделений памяти нет.
+
+    Каждая пара регистрируется в vector_instrumentation_registry при первом событии. snapshot() возвращает копию счётчиков,
+    отсортированную по числу перенесённых при росте элементов, - сверху те вектора, которым reserve поможет больше всего.
+
+        counted_vector<order, order_book_tag> orders;      // vector<order, std::allocator<order>, vector_counting_instrumentation<...>>
+        ...
+        vector_instrumentation_registry::instance().report(std::cerr);
+*/
+
+
+// Снимок счётчиков одной пары (тип, метка)
+struct vector_trace_stats {
+    std::string type;
+    std::string tag;
+    std::size_t element_size = 0;
+
+    std::uint64_t allocations = 0;
+    std::uint64_t reallocations = 0;
+    std::uint64_t relocated_elements = 0;
+    std::uint64_t shifts = 0;
+    std::uint64_t shifted_elements = 0;
+    std::uint64_t shrinks = 0;
+    std::uint64_t shrink_relocated_elements = 0;
+
+    std::uint64_t relocated_bytes() const noexcept {
+        return (relocated_elements + shifted_elements + shrink_relocated_elements) * element_size;
+    }
+};
+
+
+class vector_instrumentation_registry {
+    public:
+
+    // Живые счётчики одной пары; объект статический и живёт до конца программы
+    struct counters {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> reallocations{0};
+        std::atomic<std::uint64_t> relocated_elements{0};
+        std::atomic<std::uint64_t> shifts{0};
+        std::atomic<std::uint64_t> shifted_elements{0};
+        std::atomic<std::uint64_t> shrinks{0};
+        std::atomic<std::uint64_t> shrink_relocated_elements{0};
+    };
+
+    private:
+
+    struct entry {
+        std::string type;
+        std::string tag;
+        std::size_t element_size;
+        counters* stats;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<entry> entries_;
+
+    vector_instrumentation_registry() = default;
+
+    public:
+
+    vector_instrumentation_registry(const vector_instrumentation_registry&) = delete;
+    vector_instrumentation_registry& operator=(const vector_instrumentation_registry&) = delete;
+
+    static vector_instrumentation_registry& instance() {
+        static vector_instrumentation_registry registry;
+        return registry;
+    }
+
+    // Имя типа для отчёта; в GCC и Clang - разманглированное
+    static std::string type_name(const std::type_info& info) {
+#if defined(__GNUG__)
+        int status = 0;
+        std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(info.name(), nullptr, nullptr, &status), std::free);
+        if (status == 0 && demangled) {
+            return demangled.get();
+        }
+#endif
+        return info.name();
+    }
+
+    /*
+        Регистрация вызывается из noexcept-кода vector, поэтому нехватка памяти здесь только теряет строку отчёта.
+        Если у метки нет имени, но она задана (tag_type != nullptr), в отчёт идёт имя её типа.
+    */
+    void add(const std::type_info& type, std::string_view tag, const std::type_info* tag_type, std::size_t element_size, counters* stats) noexcept {
+        try {
+            entry e{type_name(type), tag.empty() && tag_type != nullptr ? type_name(*tag_type) : std::string(tag), element_size, stats};
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.push_back(std::move(e));
+        } catch (...) {
+        }
+    }
+
+    std::vector<vector_trace_stats> snapshot() const {
+        std::vector<vector_trace_stats> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result.reserve(entries_.size());
+            for (const entry& e : entries_) {
+                vector_trace_stats s;
+                s.type = e.type;
+                s.tag = e.tag;
+                s.element_size = e.element_size;
+                s.allocations = e.stats->allocations.load(std::memory_order_relaxed);
+                s.reallocations = e.stats->reallocations.load(std::memory_order_relaxed);
+                s.relocated_elements = e.stats->relocated_elements.load(std::memory_order_relaxed);
+                s.shifts = e.stats->shifts.load(std::memory_order_relaxed);
+                s.shifted_elements = e.stats->shifted_elements.load(std::memory_order_relaxed);
+                s.shrinks = e.stats->shrinks.load(std::memory_order_relaxed);
+                s.shrink_relocated_elements = e.stats->shrink_relocated_elements.load(std::memory_order_relaxed);
+                result.push_back(std::move(s));
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const vector_trace_stats& a, const vector_trace_stats& b) {
+            return a.relocated_elements > b.relocated_elements;
+        });
+        return result;
+    }
+
+    // Обнуляет счётчики, регистрации сохраняются
+    void reset() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const entry& e : entries_) {
+            e.stats->allocations.store(0, std::memory_order_relaxed);
+            e.stats->reallocations.store(0, std::memory_order_relaxed);
+            e.stats->relocated_elements.store(0, std::memory_order_relaxed);
+            e.stats->shifts.store(0, std::memory_order_relaxed);
+            e.stats->shifted_elements.store(0, std::memory_order_relaxed);
+            e.stats->shrinks.store(0, std::memory_order_relaxed);
+            e.stats->shrink_relocated_elements.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void report(std::ostream& os) const {
+        os << std::left << std::setw(32) << "type" << std::setw(16) << "tag" << std::right << std::setw(12) << "allocs"
+           << std::setw(12) << "reallocs" << std::setw(14) << "relocated" << std::setw(12) << "shifts" << std::setw(14) << "shifted"
+           << std::setw(10) << "shrinks" << std::setw(16) << "moved bytes" << '\n';
+        for (const vector_trace_stats& s : snapshot()) {
+            os << std::left << std::setw(32) << s.type << std::setw(16) << (s.tag.empty() ? "-" : s.tag) << std::right
+               << std::setw(12) << s.allocations << std::setw(12) << s.reallocations << std::setw(14) << s.relocated_elements
+               << std::setw(12) << s.shifts << std::setw(14) << s.shifted_elements << std::setw(10) << s.shrinks
+               << std::setw(16) << s.relocated_bytes() << '\n';
+        }
+    }
+};
+
+
+
+template <typename Tag>
+constexpr std::string_view vector_trace_tag_name() {
+    if constexpr (std::is_void_v<Tag>) {
+        return "";
+    } else if constexpr (requires { { Tag::name } -> std::convertible_to<std::string_view>; }) {
+        return Tag::name;
+    } else {
+        return {};
+    }
+}
+
+
+template <typename Tag = void>
+struct vector_counting_instrumentation {
+    private:
+
+    // Свои счётчики на каждую пару (T, Tag); регистрируются один раз при первом обращении
+    template <typename T>
+    static vector_instrumentation_registry::counters& stats() noexcept {
+        static vector_instrumentation_registry::counters* counters = [] {
+            static vector_instrumentation_registry::counters storage;
+            const std::type_info* tag_type = nullptr;
+            if constexpr (!std::is_void_v<Tag>) {
+                tag_type = &typeid(Tag);
+            }
+            vector_instrumentation_registry::instance().add(typeid(T), vector_trace_tag_name<Tag>(), tag_type, sizeof(T), &storage);
+            return &storage;
+        }();
+        return *counters;
+    }
+
+    public:
+
+    template <typename T>
+    static void on_allocate(std::size_t) noexcept {
+        stats<T>().allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void on_reallocate(std::size_t, std::size_t, std::size_t moved) noexcept {
+        auto& s = stats<T>();
+        s.reallocations.fetch_add(1, std::memory_order_relaxed);
+        s.relocated_elements.fetch_add(moved, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void on_shift(std::size_t count) noexcept {
+        auto& s = stats<T>();
+        s.shifts.fetch_add(1, std::memory_order_relaxed);
+        s.shifted_elements.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void on_shrink_to_fit(std::size_t, std::size_t, std::size_t moved) noexcept {
+        auto& s = stats<T>();
+        s.shrinks.fetch_add(1, std::memory_order_relaxed);
+        s.shrink_relocated_elements.fetch_add(moved, std::memory_order_relaxed);
+    }
+};
+
+
+template <typename T, typename Tag = void>
+using counted_vector = vector<T, std::allocator<T>, vector_counting_instrumentation<Tag>>;